@@ -0,0 +1,106 @@
+/** @file   frame_clock.c
+    @author agent
+    @date   19 October 2026
+    @brief  Phase-locked estimate of the PPM frame period and phase.
+
+    A second order (alpha-beta) loop.  Each start pulse is compared
+    with its predicted time, and a quarter of the error is applied to
+    the phase and a thirty-second of it to the period, which is close
+    to critically damped.  Missed frames are skipped over, and anything
+    further than half a period from prediction resets the phase.
+*/
+
+#include "frame_clock.h"
+
+#define PHASE_SHIFT		2  /* Phase gain of 1/4.  */
+#define PERIOD_SHIFT		5  /* Period gain of 1/32.  */
+#define MAX_MISSED		4  /* Frames that can be missed without slipping.  */
+#define PERIOD_MIN_NS		4000000LL  /* Shortest plausible frame period.  */
+#define PERIOD_MAX_NS		50000000LL /* Longest plausible frame period.  */
+
+
+/** Initialise a frame clock.
+    @param fc pointer to frame clock
+    @param period_ns period to assume until it has been measured  */
+void
+frame_clock_init (frame_clock_t *fc, long long period_ns)
+{
+    fc->period_ns = period_ns;
+    fc->next_ns = 0;
+    fc->in_lock = 0;
+    fc->slips = 0;
+    fc->started = false;
+}
+
+
+/** Update the estimate with the time of a start pulse.
+    @param fc pointer to frame clock
+    @param t_ns time of the start pulse  */
+void
+frame_clock_sync (frame_clock_t *fc, long long t_ns)
+{
+    long long err, half = fc->period_ns >> 1;
+
+    if (!fc->started)
+    {
+        fc->next_ns = t_ns + fc->period_ns;
+        fc->started = true;
+        return;
+    }
+
+    err = t_ns - fc->next_ns;
+
+    /* Skip over frames that were missed altogether.  */
+    if (err > half && err < MAX_MISSED * fc->period_ns + half)
+    {
+        long long missed = FRAME_CLOCK_DIV (err + half, fc->period_ns);
+        fc->next_ns += missed * fc->period_ns;
+        err -= missed * fc->period_ns;
+    }
+
+    if (err > half || err < -half)
+    {
+        /* Lost track, so start again from this start pulse.  If this is
+           only the second start pulse, take the period from it.  */
+        long long period = t_ns - (fc->next_ns - fc->period_ns);
+        if (fc->in_lock == 0 && period >= PERIOD_MIN_NS && period <= PERIOD_MAX_NS)
+            fc->period_ns = period;
+        fc->next_ns = t_ns + fc->period_ns;
+        fc->in_lock = 0;
+        fc->slips++;
+        return;
+    }
+
+    fc->next_ns += fc->period_ns + (err >> PHASE_SHIFT);
+    fc->period_ns += err >> PERIOD_SHIFT;
+    if (fc->period_ns < PERIOD_MIN_NS)
+        fc->period_ns = PERIOD_MIN_NS;
+    else if (fc->period_ns > PERIOD_MAX_NS)
+        fc->period_ns = PERIOD_MAX_NS;
+
+    if (err < (fc->period_ns >> 4) && err > -(fc->period_ns >> 4))
+    {
+        if (fc->in_lock < FRAME_CLOCK_LOCK_COUNT)
+            fc->in_lock++;
+    }
+    else
+    {
+        fc->in_lock = 0;
+    }
+}
+
+
+/** Return the first predicted start pulse after a given time.
+    @param fc pointer to frame clock
+    @param after_ns time to predict from
+    @return predicted time of start pulse.  */
+long long
+frame_clock_next (const frame_clock_t *fc, long long after_ns)
+{
+    long long next = fc->next_ns;
+
+    if (next <= after_ns)
+        next += (FRAME_CLOCK_DIV (after_ns - next, fc->period_ns) + 1) * fc->period_ns;
+
+    return next;
+}
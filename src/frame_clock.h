@@ -0,0 +1,67 @@
+/** @file   frame_clock.h
+    @author agent
+    @date   19 October 2026
+    @brief  Phase-locked estimate of the PPM frame period and phase.
+
+    Like ppm.c this has no kernel dependencies, so it can also be
+    built in userspace.
+*/
+
+#ifndef _FRAME_CLOCK_H
+#define _FRAME_CLOCK_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#include <linux/math64.h>
+#define FRAME_CLOCK_DIV(A, B) div64_s64 ((A), (B))
+#else
+#include <stdbool.h>
+#define FRAME_CLOCK_DIV(A, B) ((A) / (B))
+#endif
+
+/** Number of consecutive start pulses within a sixteenth of a period
+    of their prediction before the clock counts as locked.  */
+#define FRAME_CLOCK_LOCK_COUNT	4
+
+/* Times are in nanoseconds, on whatever clock the caller uses.  */
+typedef struct frame_clock_struct
+{
+    long long period_ns;        /* Estimated frame period.  */
+    long long next_ns;          /* Predicted time of the next start pulse.  */
+    unsigned int in_lock;       /* Consecutive start pulses close to prediction.  */
+    unsigned int slips;         /* Times the phase had to be reset.  */
+    bool started;               /* A start pulse has been seen.  */
+} frame_clock_t;
+
+
+/** Initialise a frame clock.
+    @param fc pointer to frame clock
+    @param period_ns period to assume until it has been measured  */
+extern void
+frame_clock_init (frame_clock_t *fc, long long period_ns);
+
+
+/** Update the estimate with the time of a start pulse.
+    @param fc pointer to frame clock
+    @param t_ns time of the start pulse  */
+extern void
+frame_clock_sync (frame_clock_t *fc, long long t_ns);
+
+
+/** Return the first predicted start pulse after a given time.  Carries
+    on at the estimated period while no start pulses arrive.
+    @param fc pointer to frame clock
+    @param after_ns time to predict from
+    @return predicted time of start pulse.  */
+extern long long
+frame_clock_next (const frame_clock_t *fc, long long after_ns);
+
+
+/** Return non-zero if the clock is locked to the start pulses.  */
+static inline bool
+frame_clock_locked (const frame_clock_t *fc)
+{
+    return fc->in_lock >= FRAME_CLOCK_LOCK_COUNT;
+}
+
+#endif
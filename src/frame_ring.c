@@ -0,0 +1,131 @@
+/** @file   frame_ring.c
+    @author agent
+    @date   19 October 2026
+    @brief  Broadcast ring of decoded PPM frames.
+*/
+
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include <linux/compiler.h>
+#include <asm/barrier.h>
+#include "frame_ring.h"
+
+
+/** Initialise a broadcast ring.
+    @param ring pointer to broadcast ring structure  */
+void
+frame_ring_init (frame_ring_t *ring)
+{
+    int i;
+
+    /* Give every slot a sequence number that does not match its
+       index, so that nothing reads as valid before it is written.  */
+    for (i = 0; i < FRAME_RING_SIZE; i++)
+        ring->slot[i].seq = i - 1;
+    ring->head = 0;
+    ring->claimed = false;
+}
+
+
+/** Claim the next slot for writing.
+    @param ring pointer to broadcast ring structure
+    @return pointer to frame to fill in.  */
+frame_t *
+frame_ring_claim (frame_ring_t *ring)
+{
+    frame_t *slot = &ring->slot[ring->head & FRAME_RING_MASK];
+
+    if (!ring->claimed)
+    {
+        /* Invalidate the oldest frame before overwriting it.  head - 1
+           lives in a different slot, so no reader can be looking for
+           that sequence number here.  */
+        WRITE_ONCE (slot->seq, ring->head - 1);
+        smp_wmb ();
+        ring->claimed = true;
+    }
+    return slot;
+}
+
+
+/** Publish the claimed slot to all readers.
+    @param ring pointer to broadcast ring structure  */
+void
+frame_ring_commit (frame_ring_t *ring)
+{
+    frame_t *slot = &ring->slot[ring->head & FRAME_RING_MASK];
+
+    if (!ring->claimed)
+        return;
+
+    /* Make the frame contents visible before its sequence number, and
+       the sequence number visible before the new head.  */
+    smp_wmb ();
+    WRITE_ONCE (slot->seq, ring->head);
+    smp_wmb ();
+    WRITE_ONCE (ring->head, ring->head + 1);
+    ring->claimed = false;
+}
+
+
+/** Initialise a reader cursor at the most recently committed frame.
+    @param ring pointer to broadcast ring structure
+    @param cursor pointer to reader cursor  */
+void
+frame_cursor_init (frame_ring_t *ring, frame_cursor_t *cursor)
+{
+    unsigned int head = READ_ONCE (ring->head);
+
+    cursor->seq = head ? head - 1 : 0;
+    cursor->lapped = 0;
+}
+
+
+/** Read the next unread frame for a reader.
+    @param ring pointer to broadcast ring structure
+    @param cursor pointer to reader cursor
+    @param frame pointer to frame to copy into
+    @return non-zero if a frame was read, zero if none is available.  */
+int
+frame_ring_read (frame_ring_t *ring, frame_cursor_t *cursor, frame_t *frame)
+{
+    for (;;)
+    {
+        unsigned int head, seq;
+        const frame_t *slot;
+
+        head = READ_ONCE (ring->head);
+        smp_rmb ();
+
+        seq = cursor->seq;
+        if (seq == head)
+            return 0;
+
+        /* The slot at head may already be claimed by the writer, so
+           only FRAME_RING_SIZE - 1 frames are guaranteed readable.  */
+        if (head - seq > FRAME_RING_SIZE - 1)
+        {
+            cursor->lapped += head - seq - (FRAME_RING_SIZE - 1);
+            seq = head - (FRAME_RING_SIZE - 1);
+        }
+
+        slot = &ring->slot[seq & FRAME_RING_MASK];
+        if (READ_ONCE (slot->seq) == seq)
+        {
+            smp_rmb ();
+            memcpy (frame, slot, sizeof (*frame));
+            smp_rmb ();
+
+            /* Check the writer did not reclaim the slot under us.  */
+            if (READ_ONCE (slot->seq) == seq)
+            {
+                cursor->seq = seq + 1;
+                return 1;
+            }
+        }
+
+        /* Lapped while reading this slot, so skip it and try again.  */
+        cursor->lapped++;
+        cursor->seq = seq + 1;
+    }
+}
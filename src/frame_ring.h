@@ -0,0 +1,86 @@
+/** @file   frame_ring.h
+    @author agent
+    @date   19 October 2026
+    @brief  Broadcast ring of decoded PPM frames.
+*/
+
+#ifndef _FRAME_RING_H
+#define _FRAME_RING_H
+
+/** Maximum number of values (channels) held in one frame.  */
+#define FRAME_MAX_VALUES	20
+
+/** Number of frames held in the ring.  Must be a power of two.  */
+#define FRAME_RING_SIZE		32
+#define FRAME_RING_MASK		(FRAME_RING_SIZE - 1)
+
+/* A single decoded frame.  seq is the sequence number of the frame
+   currently held in a ring slot, and is used by readers to detect
+   that the slot was overwritten while they were copying it.  */
+typedef struct frame_struct
+{
+    unsigned int seq;
+    unsigned int num_values;
+    unsigned int source;        /* Input the frame was decoded from.  */
+    u64 time_ns;                /* CLOCK_MONOTONIC time of the start pulse ending it.  */
+    unsigned int value[FRAME_MAX_VALUES];
+} frame_t;
+
+/* Define broadcast ring structure.  Reading a frame does not consume
+   it.  There is a single writer (the ISR), which
+   claims the slot at head, fills it in place and then commits it.
+   Every reader keeps its own frame_cursor_t, so any number of readers
+   each see every frame and no reader can slow down the writer or the
+   other readers.  A reader that falls more than a ring behind is
+   lapped; it skips forward to the oldest frame still held and the
+   number of frames it missed is accumulated in its cursor.  */
+typedef struct frame_ring_struct
+{
+    frame_t slot[FRAME_RING_SIZE];
+    unsigned int head;          /* Sequence number of next frame to commit.  */
+    bool claimed;               /* Slot at head has been claimed by writer.  */
+} frame_ring_t;
+
+typedef struct frame_cursor_struct
+{
+    unsigned int seq;           /* Sequence number of next frame to read.  */
+    unsigned int lapped;        /* Number of frames skipped by being lapped.  */
+} frame_cursor_t;
+
+
+/** Initialise a broadcast ring.
+    @param ring pointer to broadcast ring structure  */
+extern void
+frame_ring_init (frame_ring_t *ring);
+
+
+/** Claim the next slot for writing.  Claiming an already claimed slot
+    returns the same slot, so an abandoned frame is simply overwritten.
+    @param ring pointer to broadcast ring structure
+    @return pointer to frame to fill in.  */
+extern frame_t *
+frame_ring_claim (frame_ring_t *ring);
+
+
+/** Publish the claimed slot to all readers.
+    @param ring pointer to broadcast ring structure  */
+extern void
+frame_ring_commit (frame_ring_t *ring);
+
+
+/** Initialise a reader cursor at the most recently committed frame.
+    @param ring pointer to broadcast ring structure
+    @param cursor pointer to reader cursor  */
+extern void
+frame_cursor_init (frame_ring_t *ring, frame_cursor_t *cursor);
+
+
+/** Read the next unread frame for a reader.
+    @param ring pointer to broadcast ring structure
+    @param cursor pointer to reader cursor
+    @param frame pointer to frame to copy into
+    @return non-zero if a frame was read, zero if none is available.  */
+extern int
+frame_ring_read (frame_ring_t *ring, frame_cursor_t *cursor, frame_t *frame);
+
+#endif
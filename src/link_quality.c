@@ -0,0 +1,140 @@
+/** @file   link_quality.c
+    @author agent
+    @date   19 October 2026
+    @brief  Estimate of PPM link quality from 0 to 100%.
+
+    Every update is O(1): the count of good frames is kept in step with
+    the window rather than counted, and the interval and jitter are
+    exponential averages, so there is no history to walk.
+*/
+
+#include "link_quality.h"
+
+#define PERIOD_SHIFT		3  /* Interval average gain of 1/8.  */
+#define JITTER_SHIFT		3  /* Jitter average gain of 1/8.  */
+#define JITTER_US_PER_PERCENT	8  /* Quality lost per microsecond of jitter.  */
+#define JITTER_MAX_PENALTY	25 /* Most quality that jitter can cost.  */
+
+
+/* Folds the change from *last to us into the average *jitter_x16.  */
+static void
+link_quality_jitter (unsigned int *jitter_x16, unsigned int *last, unsigned int us)
+{
+    if (*last)
+    {
+        int change = (int) us - (int) *last;
+        if (change < 0)
+            change = -change;
+        *jitter_x16 += ((change << 4) - (int) *jitter_x16) >> JITTER_SHIFT;
+    }
+    *last = us;
+}
+
+
+static void
+link_quality_push (link_quality_t *lq, bool good)
+{
+    unsigned int oldest = (lq->window >> (LINK_QUALITY_WINDOW - 1)) & 1;
+
+    lq->window = (lq->window << 1) | good;
+    lq->good += good;
+    lq->good -= oldest;
+}
+
+
+static void
+link_quality_update (link_quality_t *lq)
+{
+    unsigned int penalty = link_quality_jitter_us (lq) / JITTER_US_PER_PERCENT;
+    unsigned int percent = (lq->good * 100) / LINK_QUALITY_WINDOW;
+
+    if (penalty > JITTER_MAX_PENALTY)
+        penalty = JITTER_MAX_PENALTY;
+
+    lq->quality = percent > penalty ? percent - penalty : 0;
+}
+
+
+/** Initialise an estimator, starting from no good frames.
+    @param lq pointer to estimator  */
+void
+link_quality_init (link_quality_t *lq)
+{
+    lq->window = 0;
+    lq->good = 0;
+    lq->period_us = 0;
+    lq->jitter_x16 = 0;
+    lq->sync_jitter_x16 = 0;
+    lq->last_interval_us = 0;
+    lq->last_sync_us = 0;
+    lq->quality = 0;
+}
+
+
+/** Record a start pulse.
+    @param lq pointer to estimator
+    @param interval_us time since the previous start pulse
+    @param sync_us length of this start pulse
+    @param good non-zero if the frame it ended was accepted  */
+void
+link_quality_frame (link_quality_t *lq, unsigned int interval_us,
+                    unsigned int sync_us, bool good)
+{
+    unsigned int missed = 0;
+
+    /* Count the frames that fit in an overlong interval, without
+       dividing.  The loop is bounded by the size of the window.  */
+    if (lq->period_us)
+    {
+        while (interval_us > lq->period_us + (lq->period_us >> 1)
+               && missed < LINK_QUALITY_WINDOW)
+        {
+            interval_us -= lq->period_us;
+            missed++;
+        }
+    }
+    if (missed)
+        link_quality_missed (lq, missed);
+
+    if (good && !missed)
+    {
+        if (lq->period_us == 0)
+            lq->period_us = interval_us;
+        else
+            lq->period_us += ((int) interval_us - (int) lq->period_us) >> PERIOD_SHIFT;
+
+        link_quality_jitter (&lq->jitter_x16, &lq->last_interval_us, interval_us);
+        link_quality_jitter (&lq->sync_jitter_x16, &lq->last_sync_us, sync_us);
+    }
+    else
+    {
+        /* The next interval is not comparable with this one */
+        lq->last_interval_us = 0;
+        lq->last_sync_us = 0;
+    }
+
+    link_quality_push (lq, good);
+    link_quality_update (lq);
+}
+
+
+/** Record frames that were missed without a start pulse to end them.
+    @param lq pointer to estimator
+    @param missed number of frames missed  */
+void
+link_quality_missed (link_quality_t *lq, unsigned int missed)
+{
+    if (missed >= LINK_QUALITY_WINDOW)
+    {
+        lq->window = 0;
+        lq->good = 0;
+    }
+    else
+    {
+        while (missed--)
+            link_quality_push (lq, false);
+    }
+    lq->last_interval_us = 0;
+    lq->last_sync_us = 0;
+    link_quality_update (lq);
+}
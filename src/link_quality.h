@@ -0,0 +1,77 @@
+/** @file   link_quality.h
+    @author agent
+    @date   19 October 2026
+    @brief  Estimate of PPM link quality from 0 to 100%.
+
+    Like ppm.c this has no kernel dependencies, so it can also be
+    built in userspace.
+*/
+
+#ifndef _LINK_QUALITY_H
+#define _LINK_QUALITY_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#include <stdint.h>
+typedef uint64_t u64;
+#endif
+
+/** Number of frame slots in the sliding window.  */
+#define LINK_QUALITY_WINDOW	64
+
+/* The window holds one bit per expected frame, most recent in bit 0,
+   set for a good frame and clear for one that was rejected or never
+   arrived.  Quality is the share of good frames in the window, less a
+   penalty for jitter.  Jitter is averaged both in the interval between
+   start pulses and in the start pulse itself, and the steadier of the
+   two is used: a transmitter keeps one of them fixed and the other
+   moves with the sticks.  */
+typedef struct link_quality_struct
+{
+    u64 window;
+    unsigned int good;          /* Number of bits set in window.  */
+    unsigned int period_us;     /* Average interval of good frames, 0 until known.  */
+    unsigned int jitter_x16;    /* Average change in interval, in 1/16 us.  */
+    unsigned int sync_jitter_x16; /* Average change in start pulse, likewise.  */
+    unsigned int last_interval_us;
+    unsigned int last_sync_us;
+    unsigned int quality;       /* 0 to 100.  */
+} link_quality_t;
+
+
+/** Initialise an estimator, starting from no good frames.
+    @param lq pointer to estimator  */
+extern void
+link_quality_init (link_quality_t *lq);
+
+
+/** Record a start pulse.  Frames that should have arrived during a
+    longer than usual interval are counted as missing.
+    @param lq pointer to estimator
+    @param interval_us time since the previous start pulse
+    @param sync_us length of this start pulse
+    @param good non-zero if the frame it ended was accepted  */
+extern void
+link_quality_frame (link_quality_t *lq, unsigned int interval_us,
+                    unsigned int sync_us, bool good);
+
+
+/** Record frames that were missed without a start pulse to end them.
+    @param lq pointer to estimator
+    @param missed number of frames missed  */
+extern void
+link_quality_missed (link_quality_t *lq, unsigned int missed);
+
+
+/** Return the average jitter in the interval between start pulses or
+    in the start pulse, whichever is steadier, in microseconds.  */
+static inline unsigned int
+link_quality_jitter_us (const link_quality_t *lq)
+{
+    return (lq->jitter_x16 < lq->sync_jitter_x16
+            ? lq->jitter_x16 : lq->sync_jitter_x16) >> 4;
+}
+
+#endif
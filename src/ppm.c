@@ -0,0 +1,553 @@
+/** @file   ppm.c
+    @author Robert Tang, John Howe
+    @date   11 September 2010
+    @brief  PPM decoding state machine.
+
+    The decoder first detects the number of channels by counting the
+    gaps between two start pulses, and then decodes each frame into
+    value[].  Only frames with exactly that many gaps, all within the
+    channel limits, and a length or start pulse consistent with the
+    frames before are reported.  The rest are counted in rejects and
+    reported as dropped, so they never reach a consumer.
+
+    Every check is made as each gap arrives or when the start pulse
+    ends the frame, so the cost per edge does not depend on the number
+    of channels.  A run of frames that are all wrong in the same way is
+    taken as the transmitter having changed, rather than as noise, and
+    the decoder relearns from it instead of dropping frames forever.
+
+    For a transmitter whose timing is not known, ppm_decode_adaptive
+    first learns the limits from the signal itself, with running
+    statistics over its first frames, and then decodes with them,
+    scaling them as the frame length drifts.
+*/
+
+#include "ppm.h"
+
+
+/* Back to detecting channels, forgetting everything learned.  */
+static void
+ppm_restart (ppm_decoder_t *dec)
+{
+    dec->mode = PPM_DETECT_CHANNELS;
+    dec->num_channels = 0;
+    dec->pulse = 0;
+    dec->bad_frame = false;
+    dec->frame_us = 0;
+    dec->num_lengths = 0;
+    dec->num_wrong = 0;
+    dec->num_votes = 0;
+}
+
+
+/* Start decoding frames of num_channels, just after a start pulse.  */
+static ppm_event_t
+ppm_lock (ppm_decoder_t *dec, unsigned int num_channels)
+{
+    /* A frame of a different layout has a different length.  */
+    if (num_channels != dec->num_channels)
+        dec->num_lengths = 0;
+
+    dec->num_channels = num_channels;
+    dec->mode = PPM_DECODE;
+    dec->pulse = 0;
+    dec->bad_frame = false;
+    dec->frame_us = 0;
+    dec->num_wrong = 0;
+    dec->num_votes = 0;
+    return PPM_EVENT_LOCK;
+}
+
+
+/* Counts a frame that is wrong in the same way as the one before, as
+   identified by its number of gaps, returning true once there has been
+   a run of them.  */
+static bool
+ppm_wrong_again (ppm_decoder_t *dec)
+{
+    if (dec->num_wrong == 0 || dec->wrong_pulses != dec->pulse)
+    {
+        dec->wrong_pulses = dec->pulse;
+        dec->num_wrong = 0;
+    }
+    return ++dec->num_wrong >= PPM_RELEARN_FRAMES;
+}
+
+
+static unsigned int
+ppm_diff (unsigned int a, unsigned int b)
+{
+    return a > b ? a - b : b - a;
+}
+
+
+static bool
+ppm_near (unsigned int us, unsigned int mean_us, unsigned int spread_us)
+{
+    return ppm_diff (us, mean_us) <= 4 * spread_us + PPM_LENGTH_SLACK_US;
+}
+
+
+/* Checks a frame ended by a start pulse of sync_us against the learned
+   length and start pulse.  Some transmitters keep the frame period
+   fixed, so the start pulse stretches as the channels shorten, and
+   others keep the start pulse fixed, so the period varies.  Either one
+   being where it was is enough, as a stick moving after a long hold
+   would otherwise be far outside the spread of the other.  */
+static bool
+ppm_length_ok (const ppm_decoder_t *dec, unsigned int sync_us)
+{
+    if (dec->num_lengths < PPM_LENGTH_LEARN)
+        return true;
+
+    return ppm_near (dec->frame_us, dec->length_us, dec->spread_us)
+        || ppm_near (sync_us, dec->sync_us, dec->sync_spread_us);
+}
+
+
+/* Moves a learned mean and its mean deviation towards us.  */
+static void
+ppm_average (unsigned int *mean_us, unsigned int *spread_us, unsigned int us)
+{
+    int delta = (int) us - (int) *mean_us;
+    int spread = (int) ppm_diff (us, *mean_us) - (int) *spread_us;
+
+    *mean_us += delta / PPM_LENGTH_WEIGHT;
+    *spread_us += spread / PPM_LENGTH_WEIGHT;
+}
+
+
+/* Folds the length and start pulse of a good frame into the learned
+   ones.  */
+static void
+ppm_length_learn (ppm_decoder_t *dec, unsigned int sync_us)
+{
+    if (dec->num_lengths == 0)
+    {
+        dec->length_us = dec->frame_us;
+        dec->spread_us = 0;
+        dec->sync_us = sync_us;
+        dec->sync_spread_us = 0;
+    }
+    else
+    {
+        ppm_average (&dec->length_us, &dec->spread_us, dec->frame_us);
+        ppm_average (&dec->sync_us, &dec->sync_spread_us, sync_us);
+    }
+
+    if (dec->num_lengths < PPM_LENGTH_LEARN)
+        dec->num_lengths++;
+}
+
+
+static unsigned int
+ppm_median (unsigned int a, unsigned int b, unsigned int c)
+{
+    if (a > b)
+    {
+        unsigned int t = a;
+
+        a = b;
+        b = t;
+    }
+    /* Now a <= b.  */
+    if (c <= a)
+        return a;
+    return c < b ? c : b;
+}
+
+
+/* Stores the gap for channel pulse, as is or as the median of it and
+   the same channel in the last two good frames.  */
+static void
+ppm_store (ppm_decoder_t *dec, const ppm_timing_t *timing,
+           unsigned int pulse, unsigned int dt_us)
+{
+    unsigned int older = dec->newest == 2 ? 0 : dec->newest + 1;
+    unsigned int old = older == 2 ? 0 : older + 1;
+
+    dec->history[dec->newest][pulse] = dt_us;
+    if (timing->vote && dec->num_votes >= 2)
+        dt_us = ppm_median (dt_us, dec->history[old][pulse],
+                            dec->history[older][pulse]);
+    dec->value[pulse] = dt_us;
+}
+
+
+/* Decides what the start pulse of sync_us ending a frame completed.  */
+static ppm_event_t
+ppm_frame_end (ppm_decoder_t *dec, unsigned int sync_us)
+{
+    if (dec->bad_frame)
+    {
+        dec->rejects.bounds++;
+        dec->num_wrong = 0;
+        return PPM_EVENT_SYNC;
+    }
+
+    if (dec->pulse != dec->num_channels)
+    {
+        dec->rejects.count++;
+        /* The same number of gaps every frame is a new layout, e.g.
+           the transmitter was switched to fewer channels.  */
+        if (ppm_wrong_again (dec) && dec->pulse > 0)
+            return ppm_lock (dec, dec->pulse);
+        return PPM_EVENT_SYNC;
+    }
+
+    if (!ppm_length_ok (dec, sync_us))
+    {
+        dec->rejects.length++;
+        /* Consistently the wrong length is a new timing.  */
+        if (ppm_wrong_again (dec))
+        {
+            dec->num_lengths = 0;
+            dec->num_wrong = 0;
+        }
+        return PPM_EVENT_SYNC;
+    }
+
+    dec->num_wrong = 0;
+    ppm_length_learn (dec, sync_us);
+
+    /* Keep this frame in the history for voting.  */
+    dec->newest = dec->newest == 2 ? 0 : dec->newest + 1;
+    if (dec->num_votes < 2)
+        dec->num_votes++;
+
+    return PPM_EVENT_FRAME;
+}
+
+
+/** Initialise a decoder, ready to detect channels, and clear its
+    reject counts.
+    @param dec pointer to decoder  */
+void
+ppm_decoder_init (ppm_decoder_t *dec)
+{
+    ppm_restart (dec);
+    dec->newest = 0;
+    dec->rejects.bounds = 0;
+    dec->rejects.count = 0;
+    dec->rejects.length = 0;
+}
+
+
+/** Abandon a lock and detect the channels again from the next frame.
+    @param dec pointer to decoder  */
+void
+ppm_decoder_unlock (ppm_decoder_t *dec)
+{
+    dec->mode = PPM_DETECT_CHANNELS;
+    dec->num_channels = 0;
+    dec->pulse = 0;
+}
+
+
+/** Decode one edge.
+    @param dec pointer to decoder
+    @param timing limits on the gaps between edges
+    @param dt_us gap since the previous edge in microseconds
+    @return what the edge completed.  */
+ppm_event_t
+ppm_decode (ppm_decoder_t *dec, const ppm_timing_t *timing, unsigned int dt_us)
+{
+    bool start = dt_us > timing->start_min_us && dt_us < timing->start_max_us;
+
+    if (dt_us > timing->start_max_us)
+    {
+        /* Have encountered rather long frame.  Need to re-detect
+           channels.  */
+        ppm_restart (dec);
+        return PPM_EVENT_RESET;
+    }
+
+    if (dec->mode == PPM_DETECT_CHANNELS)
+    {
+        if (start)
+        {
+            /* A second start pulse gives the number of channels.  */
+            if (dec->pulse > 1 && dec->pulse - 1 <= PPM_MAX_CHANNELS)
+                return ppm_lock (dec, dec->pulse - 1);
+            dec->pulse = 1;
+        }
+        else if (dt_us >= timing->pulse_min_us && dt_us <= timing->pulse_max_us
+                 && dec->pulse > 0)
+        {
+            /* Have to first receive a start pulse.  */
+            dec->pulse++;
+        }
+        else
+        {
+            /* Neither a channel nor a start pulse, so start again.  */
+            dec->pulse = 0;
+        }
+        return PPM_EVENT_NONE;
+    }
+
+    dec->frame_us += dt_us;
+
+    if (start)
+    {
+        ppm_event_t event = ppm_frame_end (dec, dt_us);
+
+        if (event != PPM_EVENT_LOCK)
+        {
+            dec->pulse = 0;
+            dec->bad_frame = false;
+            dec->frame_us = 0;
+        }
+        return event;
+    }
+
+    if (dec->pulse < dec->num_channels)
+    {
+        if (dt_us < timing->pulse_min_us || dt_us > timing->pulse_max_us)
+            dec->bad_frame = true;
+        ppm_store (dec, timing, dec->pulse++, dt_us);
+        return PPM_EVENT_NONE;
+    }
+
+    /* More gaps than channels.  Keep the channel count, so the status
+       shows as lost rather than really lost, but detect again from the
+       next start pulse, counting from none.  */
+    dec->rejects.count++;
+    dec->mode = PPM_DETECT_CHANNELS;
+    dec->pulse = 0;
+    return PPM_EVENT_DESYNC;
+}
+
+
+/** Initialise a learner, ready to learn timing from scratch.
+    @param learn pointer to learner  */
+void
+ppm_learner_init (ppm_learner_t *learn)
+{
+    learn->state = PPM_LEARN_LONGEST;
+    learn->num_gaps = 0;
+    learn->longest_us = 0;
+    learn->num_idle = 0;
+}
+
+
+/* Starts collecting the statistics of a layout, just after a sync.  */
+static void
+ppm_learn_begin (ppm_learner_t *learn)
+{
+    learn->synced = true;
+    learn->num_frames = 0;
+    learn->pulse_min_us = ~0u;
+    learn->pulse_max_us = 0;
+    learn->sync_min_us = ~0u;
+    learn->sync_max_us = 0;
+    learn->period_sum_us = 0;
+    learn->sync_sum_us = 0;
+}
+
+
+/* Abandons the layout being collected, and after too many attempts the
+   split between channels and syncs too.  */
+static void
+ppm_learn_retry (ppm_learner_t *learn)
+{
+    learn->synced = false;
+    if (++learn->num_retries > PPM_LEARN_RETRIES)
+        ppm_learner_init (learn);
+}
+
+
+/* Scales the learned timing to a frame length of length_us.  The ratio
+   is in 1/256ths, so nothing overflows 32 bits.  */
+static void
+ppm_learn_scale (ppm_learner_t *learn, unsigned int length_us)
+{
+    const ppm_timing_t *base = &learn->base;
+    ppm_timing_t *timing = &learn->timing;
+    unsigned int ratio = (length_us << 8) / learn->period_us;
+
+    timing->start_min_us = (base->start_min_us * ratio) >> 8;
+    timing->start_max_us = (base->start_max_us * ratio) >> 8;
+    timing->pulse_min_us = (base->pulse_min_us * ratio) >> 8;
+    timing->pulse_max_us = (base->pulse_max_us * ratio) >> 8;
+    learn->scaled_us = length_us;
+}
+
+
+/* Sets limits around the statistics of the layout.  Channels have to
+   be allowed to move well beyond the range they happened to cover
+   while learning, so the channel limits are generous.  They still
+   reject the short gaps that glitches make, and the sync limits
+   reject the long ones that dropouts make.  */
+static void
+ppm_learn_done (ppm_learner_t *learn)
+{
+    ppm_timing_t *base = &learn->base;
+    unsigned int period_us = learn->period_sum_us / PPM_LEARN_FRAMES;
+    unsigned int longest_us = period_us > learn->sync_max_us
+        ? period_us : learn->sync_max_us;
+
+    base->pulse_min_us = learn->pulse_min_us * 5 / 8;
+    base->pulse_max_us = learn->pulse_max_us * 3 / 2;
+    base->start_min_us = learn->sync_min_us * 3 / 4;
+    if (base->pulse_max_us > base->start_min_us)
+    {
+        /* Split the difference where the margins overlap.  */
+        base->pulse_max_us = (learn->pulse_max_us + learn->sync_min_us) / 2;
+        base->start_min_us = base->pulse_max_us;
+    }
+    base->start_max_us = longest_us * 9 / 8;
+    base->vote = false;
+
+    learn->period_us = period_us;
+    learn->sync_us = learn->sync_sum_us / PPM_LEARN_FRAMES;
+    learn->scaled_us = period_us;
+    learn->timing = *base;
+    learn->num_idle = 0;
+    learn->state = PPM_LEARNED;
+}
+
+
+/* Learns from one gap, returning true once the timing is learned.
+
+   The longest of the first gaps is taken to be a sync, and anything
+   at least half as long is then taken to be a sync too.  The range of
+   the channels and of the syncs, and the mean frame length, are then
+   kept over frames with the same number of channels.  */
+static bool
+ppm_learn_gap (ppm_learner_t *learn, unsigned int dt_us)
+{
+    if (learn->state == PPM_LEARN_LONGEST)
+    {
+        if (dt_us > learn->longest_us)
+            learn->longest_us = dt_us;
+        if (++learn->num_gaps < PPM_LEARN_GAPS)
+            return false;
+
+        learn->split_us = learn->longest_us / 2;
+        learn->num_retries = 0;
+        learn->synced = false;
+        learn->state = PPM_LEARN_LAYOUT;
+        return false;
+    }
+
+    if (dt_us < PPM_LEARN_NOISE_US || dt_us > 2 * learn->longest_us)
+    {
+        /* A glitch or a dropout.  */
+        ppm_learn_retry (learn);
+        return false;
+    }
+
+    if (dt_us < learn->split_us)
+    {
+        if (!learn->synced)
+            return false;
+        if (++learn->pulse > PPM_MAX_CHANNELS)
+        {
+            ppm_learn_retry (learn);
+            return false;
+        }
+        learn->frame_us += dt_us;
+        if (dt_us < learn->pulse_min_us)
+            learn->pulse_min_us = dt_us;
+        if (dt_us > learn->pulse_max_us)
+            learn->pulse_max_us = dt_us;
+        return false;
+    }
+
+    /* A sync, ending the frame if one had started.  */
+    if (learn->synced)
+    {
+        if (learn->pulse == 0
+            || (learn->num_frames > 0 && learn->pulse != learn->num_channels))
+        {
+            ppm_learn_retry (learn);
+        }
+        else
+        {
+            learn->num_channels = learn->pulse;
+            learn->period_sum_us += learn->frame_us + dt_us;
+            learn->sync_sum_us += dt_us;
+            if (dt_us < learn->sync_min_us)
+                learn->sync_min_us = dt_us;
+            if (dt_us > learn->sync_max_us)
+                learn->sync_max_us = dt_us;
+            if (++learn->num_frames == PPM_LEARN_FRAMES)
+            {
+                ppm_learn_done (learn);
+                return true;
+            }
+        }
+    }
+
+    if (learn->state == PPM_LEARN_LAYOUT && !learn->synced)
+        ppm_learn_begin (learn);
+    learn->pulse = 0;
+    learn->frame_us = 0;
+    return false;
+}
+
+
+/* Follows slow drift after a good frame, by scaling the timing to the
+   frame length the decoder has learned.  If the start pulse is the
+   steadier of the two, the transmitter keeps it fixed and the length
+   follows the sticks, so the length is taken from the drift of the
+   start pulse instead.  */
+static void
+ppm_learn_track (ppm_learner_t *learn, const ppm_decoder_t *dec)
+{
+    unsigned int length_us = dec->length_us;
+    unsigned int limit_us = learn->period_us / PPM_DRIFT_MAX;
+
+    learn->num_idle = 0;
+    if (dec->num_lengths < PPM_LENGTH_LEARN)
+        return;
+
+    if (dec->sync_spread_us < dec->spread_us)
+        length_us = (learn->period_us
+                     * ((dec->sync_us << 8) / learn->sync_us)) >> 8;
+
+    if (length_us > learn->period_us + limit_us)
+        length_us = learn->period_us + limit_us;
+    else if (length_us < learn->period_us - limit_us)
+        length_us = learn->period_us - limit_us;
+
+    if (ppm_diff (length_us, learn->scaled_us)
+        > learn->scaled_us / PPM_DRIFT_STEP)
+        ppm_learn_scale (learn, length_us);
+}
+
+
+/** Decode one edge with timing learned from the signal rather than
+    given.  Edges are only used for learning until the timing has been
+    learned, and the vote setting is taken from timing.
+    @param dec pointer to decoder
+    @param learn pointer to learner
+    @param timing vote setting, the limits are ignored
+    @param dt_us gap since the previous edge in microseconds
+    @return what the edge completed.  */
+ppm_event_t
+ppm_decode_adaptive (ppm_decoder_t *dec, ppm_learner_t *learn,
+                     const ppm_timing_t *timing, unsigned int dt_us)
+{
+    ppm_event_t event;
+
+    if (learn->state != PPM_LEARNED)
+    {
+        /* The sync that completes learning starts the first frame.  */
+        if (!ppm_learn_gap (learn, dt_us))
+            return PPM_EVENT_NONE;
+    }
+    else if (++learn->num_idle > PPM_RELEARN_GAPS)
+    {
+        /* Nothing decodes with this timing any more.  */
+        ppm_learner_init (learn);
+        ppm_restart (dec);
+        return PPM_EVENT_RESET;
+    }
+
+    learn->timing.vote = timing->vote;
+    event = ppm_decode (dec, &learn->timing, dt_us);
+    if (event == PPM_EVENT_FRAME)
+        ppm_learn_track (learn, dec);
+    return event;
+}
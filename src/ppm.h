@@ -0,0 +1,192 @@
+/** @file   ppm.h
+    @author Robert Tang, John Howe
+    @date   11 September 2010
+    @brief  PPM decoding state machine.
+
+    Free of any kernel or hardware dependencies, so the same decoder
+    runs in the kernel module and in userspace.
+*/
+
+#ifndef _PPM_H
+#define _PPM_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#endif
+
+/** Maximum number of channels that can be detected.  */
+#define PPM_MAX_CHANNELS	20
+
+/** Good frames averaged before the frame length and start pulse are
+    checked.  */
+#define PPM_LENGTH_LEARN	16
+
+/** The learned frame length and start pulse move 1/PPM_LENGTH_WEIGHT
+    of the way towards each good frame, so they follow slow drift.  */
+#define PPM_LENGTH_WEIGHT	8
+
+/** Slack allowed on the frame length and start pulse on top of their
+    learned spread.  */
+#define PPM_LENGTH_SLACK_US	250
+
+/** Consecutive frames of the same wrong channel count that are taken
+    as the transmitter having changed layout, and consecutive frames of
+    the wrong length and start pulse that are taken as it having changed
+    timing.  */
+#define PPM_RELEARN_FRAMES	3
+
+/* Limits on the gaps between edges, in microseconds.  */
+typedef struct ppm_timing_struct
+{
+    unsigned int start_min_us;  /* Shortest gap accepted as a start pulse.  */
+    unsigned int start_max_us;  /* Longest gap accepted as a start pulse.  */
+    unsigned int pulse_min_us;  /* Shortest gap accepted as a channel.  */
+    unsigned int pulse_max_us;  /* Longest gap accepted as a channel.  */
+    bool vote;                  /* Report each channel as the median of
+                                   its last three good frames.  */
+} ppm_timing_t;
+
+/** Gaps watched for the longest, the first step of learning timing.  */
+#define PPM_LEARN_GAPS		64
+
+/** Frames of the same layout that timing is learned from.  Must be a
+    power of two.  */
+#define PPM_LEARN_FRAMES	8
+
+/** Failed attempts at finding a consistent layout before the longest
+    gap is found again.  */
+#define PPM_LEARN_RETRIES	8
+
+/** Gaps without a good frame after which timing is learned again, e.g.
+    because the transmitter was swapped for one with other timing.  */
+#define PPM_RELEARN_GAPS	512
+
+/** Gaps shorter than this are noise, not channels.  */
+#define PPM_LEARN_NOISE_US	100
+
+/** Learned timing follows the frame length for drift of up to
+    1/PPM_DRIFT_MAX either way, in steps of 1/PPM_DRIFT_STEP.  Anything
+    more is the transmitter's layout changing, not drift.  */
+#define PPM_DRIFT_MAX		16
+#define PPM_DRIFT_STEP		128
+
+typedef enum {PPM_DETECT_CHANNELS = 0, PPM_DECODE} ppm_mode_t;
+
+/* What, if anything, an edge completed.  */
+typedef enum
+{
+    PPM_EVENT_NONE = 0,
+    PPM_EVENT_FRAME,    /* Start pulse ending a good frame, now in value.  */
+    PPM_EVENT_SYNC,     /* Start pulse ending a frame that was dropped.  */
+    PPM_EVENT_LOCK,     /* Channels detected, num_channels is now valid.  */
+    PPM_EVENT_DESYNC,   /* Too many channels, so detecting them again.  */
+    PPM_EVENT_RESET     /* Gap too long, so detecting from scratch.  */
+} ppm_event_t;
+
+/* Frames dropped rather than reported, by reason.  These count from
+   ppm_decoder_init and are not cleared when the decoder resets.  */
+typedef struct ppm_rejects_struct
+{
+    unsigned int bounds;        /* A gap outside the channel limits.  */
+    unsigned int count;         /* Wrong number of gaps.  */
+    unsigned int length;        /* Neither the length nor the start pulse
+                                   consistent with the learned ones.  */
+} ppm_rejects_t;
+
+typedef struct ppm_decoder_struct
+{
+    ppm_mode_t mode;
+    unsigned int num_channels;  /* 0 until channels have been detected.  */
+    unsigned int pulse;         /* Index of the next gap within the frame.  */
+    bool bad_frame;             /* Current frame has a gap out of bounds.  */
+    unsigned int frame_us;      /* Sum of the gaps since the last start.  */
+    unsigned int length_us;     /* Learned frame length.  */
+    unsigned int spread_us;     /* Mean deviation from length_us.  */
+    unsigned int sync_us;       /* Learned start pulse.  */
+    unsigned int sync_spread_us; /* Mean deviation from sync_us.  */
+    unsigned int num_lengths;   /* Good frames in length_us, saturating.  */
+    unsigned int num_wrong;     /* Consecutive frames of the same fault.  */
+    unsigned int wrong_pulses;  /* Gaps in each of those frames.  */
+    unsigned int num_votes;     /* Good frames in history, up to 2.  */
+    unsigned int newest;        /* Row of history being filled.  */
+    unsigned int history[3][PPM_MAX_CHANNELS];
+    ppm_rejects_t rejects;
+    unsigned int value[PPM_MAX_CHANNELS];
+} ppm_decoder_t;
+
+
+typedef enum {PPM_LEARN_LONGEST = 0, PPM_LEARN_LAYOUT, PPM_LEARNED} ppm_learn_state_t;
+
+/* Learns the timing of an unknown transmitter from its first frames,
+   and then follows slow drift in it.  */
+typedef struct ppm_learner_struct
+{
+    ppm_learn_state_t state;
+    unsigned int num_gaps;      /* Gaps seen while finding the longest.  */
+    unsigned int longest_us;
+    unsigned int split_us;      /* Gaps at least this long are syncs.  */
+    unsigned int num_retries;   /* Layouts abandoned since the longest.  */
+    bool synced;                /* Have seen a sync since the last retry.  */
+    unsigned int pulse;         /* Channels since the last sync.  */
+    unsigned int num_channels;  /* In the first frame of the layout.  */
+    unsigned int num_frames;    /* Consistent frames of the layout.  */
+    unsigned int frame_us;      /* Sum of the gaps since the last sync.  */
+    unsigned int pulse_min_us;  /* Range of the channels so far.  */
+    unsigned int pulse_max_us;
+    unsigned int sync_min_us;   /* Range of the syncs so far.  */
+    unsigned int sync_max_us;
+    unsigned int period_sum_us; /* Sum of the frame lengths so far.  */
+    unsigned int period_us;     /* Frame length base was learned at.  */
+    unsigned int sync_sum_us;   /* Sum of the syncs so far.  */
+    unsigned int sync_us;       /* Mean sync base was learned at.  */
+    unsigned int scaled_us;     /* Frame length timing is scaled to.  */
+    unsigned int num_idle;      /* Gaps since the last good frame.  */
+    ppm_timing_t base;          /* Timing as learned.  */
+    ppm_timing_t timing;        /* Timing following drift.  */
+} ppm_learner_t;
+
+
+/** Initialise a decoder, ready to detect channels, and clear its
+    reject counts.
+    @param dec pointer to decoder  */
+extern void
+ppm_decoder_init (ppm_decoder_t *dec);
+
+
+/** Decode one edge.
+    @param dec pointer to decoder
+    @param timing limits on the gaps between edges
+    @param dt_us gap since the previous edge in microseconds
+    @return what the edge completed.  */
+extern ppm_event_t
+ppm_decode (ppm_decoder_t *dec, const ppm_timing_t *timing, unsigned int dt_us);
+
+
+/** Abandon a lock reported by ppm_decode, e.g. because it could not be
+    published, and detect the channels again from the next frame.
+    @param dec pointer to decoder  */
+extern void
+ppm_decoder_unlock (ppm_decoder_t *dec);
+
+
+/** Initialise a learner, ready to learn timing from scratch.
+    @param learn pointer to learner  */
+extern void
+ppm_learner_init (ppm_learner_t *learn);
+
+
+/** Decode one edge with timing learned from the signal rather than
+    given.  Edges are only used for learning until the timing has been
+    learned, and the vote setting is taken from timing.
+    @param dec pointer to decoder
+    @param learn pointer to learner
+    @param timing vote setting, the limits are ignored
+    @param dt_us gap since the previous edge in microseconds
+    @return what the edge completed.  */
+extern ppm_event_t
+ppm_decode_adaptive (ppm_decoder_t *dec, ppm_learner_t *learn,
+                     const ppm_timing_t *timing, unsigned int dt_us);
+
+#endif
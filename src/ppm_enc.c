@@ -0,0 +1,155 @@
+/** @file   ppm_enc.c
+    @author agent
+    @date   19 October 2026
+    @brief  PPM encoder, the inverse of ppm.c.
+
+    The output is a list of segments, two per channel and two for the
+    sync gap, each a level held for a time.  A new frame given with
+    ppm_enc_set is only picked up at the start of a frame, so a frame
+    is never sent half old and half new.
+*/
+
+#include "ppm_enc.h"
+
+
+/** Initialise an encoder, idle until it is given a frame.
+    @param enc pointer to encoder
+    @param mark_us width of the low mark before each gap
+    @param sync_min_us shortest sync gap  */
+void
+ppm_enc_init (ppm_enc_t *enc, unsigned int mark_us, unsigned int sync_min_us)
+{
+    enc->mark_us = mark_us;
+    enc->sync_min_us = sync_min_us;
+    enc->num_channels = 0;
+    enc->period_us = 0;
+    enc->sync_us = 0;
+    enc->segment = 0;
+    enc->pending = false;
+    enc->frames = 0;
+}
+
+
+/** Set the frame to send, from the start of the next frame.
+    @param enc pointer to encoder
+    @param num_channels number of channels
+    @param value width of each channel in microseconds
+    @param period_us frame period in microseconds
+    @return 0 if accepted, -1 if not.  */
+int
+ppm_enc_set (ppm_enc_t *enc, unsigned int num_channels,
+             const unsigned int *value, unsigned int period_us)
+{
+    unsigned int i, total = 0;
+
+    if (num_channels == 0 || num_channels > PPM_MAX_CHANNELS)
+        return -1;
+
+    for (i = 0; i < num_channels; i++)
+    {
+        if (value[i] <= enc->mark_us || value[i] > period_us)
+            return -1;
+        total += value[i];
+    }
+    if (total > period_us || period_us - total < enc->sync_min_us)
+        return -1;
+
+    for (i = 0; i < num_channels; i++)
+        enc->next_value[i] = value[i];
+    enc->next_num_channels = num_channels;
+    enc->next_period_us = period_us;
+    enc->pending = true;
+
+    return 0;
+}
+
+
+/* Start a frame, picking up any pending one.  */
+static void
+ppm_enc_start_frame (ppm_enc_t *enc)
+{
+    unsigned int i, total = 0;
+
+    if (enc->pending)
+    {
+        for (i = 0; i < enc->next_num_channels; i++)
+            enc->value[i] = enc->next_value[i];
+        enc->num_channels = enc->next_num_channels;
+        enc->period_us = enc->next_period_us;
+        enc->pending = false;
+    }
+
+    for (i = 0; i < enc->num_channels; i++)
+        total += enc->value[i];
+    enc->sync_us = enc->period_us - total;
+    enc->segment = 0;
+    if (enc->num_channels)
+        enc->frames++;
+}
+
+
+/** Step to the next segment of the output.
+    @param enc pointer to encoder
+    @param level set to the level to output for the segment
+    @param falling set if the segment starts with a falling edge
+    @return duration of the segment in microseconds.  */
+unsigned int
+ppm_enc_next (ppm_enc_t *enc, bool *level, bool *falling)
+{
+    unsigned int gap;
+
+    if (enc->num_channels == 0 || enc->segment >= 2 * enc->num_channels + 2)
+        ppm_enc_start_frame (enc);
+
+    if (enc->num_channels == 0)
+    {
+        /* Idle, check again for a frame after a while.  */
+        enc->segment = 0;
+        *level = true;
+        *falling = false;
+        return PPM_ENC_IDLE_US;
+    }
+
+    gap = enc->segment / 2 < enc->num_channels
+        ? enc->value[enc->segment / 2] : enc->sync_us;
+
+    if ((enc->segment++ & 1) == 0)
+    {
+        *level = false;
+        *falling = true;
+        return enc->mark_us;
+    }
+    *level = true;
+    *falling = false;
+    return gap - enc->mark_us;
+}
+
+
+/** Initialise jitter statistics.
+    @param jitter pointer to statistics  */
+void
+ppm_enc_jitter_init (ppm_enc_jitter_t *jitter)
+{
+    jitter->count = 0;
+    jitter->max_ns = 0;
+    jitter->sum_ns = 0;
+}
+
+
+/** Record how late an edge was output.
+    @param jitter pointer to statistics
+    @param late_ns time after it was due, negative if early  */
+void
+ppm_enc_jitter_record (ppm_enc_jitter_t *jitter, long long late_ns)
+{
+    unsigned int abs_ns;
+
+    if (late_ns < 0)
+        late_ns = -late_ns;
+    abs_ns = late_ns > 0xffffffffLL ? 0xffffffff : late_ns;
+
+    jitter->count++;
+    jitter->sum_ns += abs_ns;
+    if (abs_ns > jitter->max_ns)
+        jitter->max_ns = abs_ns;
+}
@@ -0,0 +1,103 @@
+/** @file   ppm_enc.h
+    @author agent
+    @date   19 October 2026
+    @brief  PPM encoder, the inverse of ppm.c.
+
+    Like ppm.c this has no kernel dependencies, so the same encoder
+    drives the output in the kernel module and a software model of it
+    in userspace.
+*/
+
+#ifndef _PPM_ENC_H
+#define _PPM_ENC_H
+
+#ifdef __KERNEL__
+#include <linux/types.h>
+#else
+#include <stdbool.h>
+#endif
+
+#include "ppm.h"
+
+/** Output held high while there is no frame to send, in microseconds.  */
+#define PPM_ENC_IDLE_US		20000
+
+/* Each channel is a low mark of mark_us followed by the output going
+   high for the rest of its width, so a channel is the gap between two
+   falling edges, as ppm.c measures it by default.  The frame ends
+   with one more mark and a long high sync gap, whatever is left of
+   the period.  */
+typedef struct ppm_enc_struct
+{
+    unsigned int mark_us;       /* Width of the low mark before each gap.  */
+    unsigned int sync_min_us;   /* Shortest sync gap accepted by ppm_enc_set.  */
+
+    /* Frame being sent.  */
+    unsigned int num_channels;  /* 0 while idle.  */
+    unsigned int period_us;
+    unsigned int value[PPM_MAX_CHANNELS];
+    unsigned int sync_us;
+    unsigned int segment;       /* Index of the next segment within the frame.  */
+
+    /* Frame to send from the start of the next one.  */
+    bool pending;
+    unsigned int next_num_channels;
+    unsigned int next_period_us;
+    unsigned int next_value[PPM_MAX_CHANNELS];
+
+    unsigned int frames;        /* Frames started.  */
+} ppm_enc_t;
+
+/* How late each edge was, in nanoseconds.  */
+typedef struct ppm_enc_jitter_struct
+{
+    unsigned int count;
+    unsigned int max_ns;
+    long long sum_ns;
+} ppm_enc_jitter_t;
+
+
+/** Initialise an encoder, idle until it is given a frame.
+    @param enc pointer to encoder
+    @param mark_us width of the low mark before each gap
+    @param sync_min_us shortest sync gap, which the decoder must see as
+           a start pulse  */
+extern void
+ppm_enc_init (ppm_enc_t *enc, unsigned int mark_us, unsigned int sync_min_us);
+
+
+/** Set the frame to send, from the start of the next frame.  It is
+    repeated until replaced.
+    @param enc pointer to encoder
+    @param num_channels number of channels, 1 to PPM_MAX_CHANNELS
+    @param value width of each channel in microseconds
+    @param period_us frame period in microseconds
+    @return 0 if accepted, -1 if a channel is no wider than the mark or
+            the period leaves less than sync_min_us for the sync gap.  */
+extern int
+ppm_enc_set (ppm_enc_t *enc, unsigned int num_channels,
+             const unsigned int *value, unsigned int period_us);
+
+
+/** Step to the next segment of the output.
+    @param enc pointer to encoder
+    @param level set to the level to output for the segment
+    @param falling set if the segment starts with a falling edge
+    @return duration of the segment in microseconds.  */
+extern unsigned int
+ppm_enc_next (ppm_enc_t *enc, bool *level, bool *falling);
+
+
+/** Initialise jitter statistics.
+    @param jitter pointer to statistics  */
+extern void
+ppm_enc_jitter_init (ppm_enc_jitter_t *jitter);
+
+
+/** Record how late an edge was output.
+    @param jitter pointer to statistics
+    @param late_ns time after it was due, negative if early  */
+extern void
+ppm_enc_jitter_record (ppm_enc_jitter_t *jitter, long long late_ns);
+
+#endif
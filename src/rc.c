@@ -8,15 +8,115 @@ Creates a kernel module (/dev/rc) which decodes a PPM signal.
 The hardware is of an omap board, such as a gumstix or a
 beagleboard SBC. It currently uses GPIO_144.
 
+The edges come from a backend, chosen with the backend module
+parameter. The only one is "gpio" (rc_gpio.c), which uses gpiolib and
+kernel timestamps, and runs on any board or on a host against
+gpio-sim. It is also the OMAP path: on a gumstix GPIO_144 is line 16
+of the OMAP GPIO5 bank, named in the device tree as <&gpio5 16 ...>.
+The module needs a 5.5 or later kernel, so the board has to run a
+current kernel rather than the 2.6 Overo image.
+
 The module works by using interrupts and timestamping with an
 internal timer. Firstly, it automatically detects the number of
-channels in the PPM signal, and then decodes the signal. Each
+channels in the PPM signal, and then decodes the signal. The
+decoding state machine itself is in ppm.c, which has no kernel
+dependencies so it can also be built and tested in userspace. Each
 time the module is read, It puts the status ("OK", LOST", or
 "REALLY_LOST"), followed by the value of each channel, separated
 with a comma, and null terminated. e.g. (using a test signal):
-"cat /dev/rc returns" RC_OK,102,199,295,392,488,585,681,777\n
+"cat /dev/rc returns" RC_OK,1020,1990,2950,3920,4880,5850,6810,7770\n
+Values are in microseconds.
+
+Decoded frames are kept in a broadcast ring. Every open file has
+its own read cursor, so several programs can open /dev/rc at once
+and each of them sees every frame. A reader that falls a whole ring
+behind skips to the oldest frame held, and RC_IOC_GET_STATUS returns
+how many frames it has skipped.
+
+Each text read returns one line and leaves the file position after
+it, so "cat /dev/rc" prints a single line. Readers that poll rewind
+with lseek() before each read.
+
+The decoder configuration (number of channels, timing profile) is
+an immutable rc_config_t published with RCU. Readers take no locks,
+and the ISR never waits for a reader when it replaces it.
+
+Each completed frame is formatted into text once, by a work item
+outside the ISR, and cached in a pair of buffers. Reads of that
+frame just copy the cached text.
+
+The timing profile can be changed at run time through sysfs, in
+/sys/class/misc/rc/. Writing "standard" or "fast" to profile selects
+a preset, and start_min_us, start_max_us, pulse_min_us, pulse_max_us
+and edge adjust the current profile. Each write takes effect from
+the next edge, without reloading the module.
+
+For a transmitter that fits neither preset, writing "adaptive" to
+profile has each input learn its own limits from its first frames
+(see ppm_decode_adaptive() in ppm.c), then follow slow drift in them,
+and learn them again if nothing decodes with them for a while. The
+learned limits of the active input are shown in the *_us files, and
+writing to one of those leaves adaptive mode.
+
+Bad frames are dropped by the decoder in the ISR, before any reader is
+woken: frames with a gap out of bounds, with the wrong number of gaps,
+or whose length is inconsistent with the frames before. They are
+counted by reason in rejected_bounds, rejected_count and
+rejected_length in sysfs, and in total by RC_IOC_GET_STATUS. Writing 1
+to vote reports each channel as the median of its last three good
+frames, which removes single frame outliers at the cost of a frame of
+lag on steps.
+
+The channels are also presented as an evdev joystick (rc_input.c),
+with one absolute axis per channel, so standard input tools can use
+them without parsing text.
+
+For logging every frame there is also an IIO device (rc_iio.c),
+with a channel per RC channel and a timestamp, filled from the IIO
+buffered capture path.
+
+Each open file can be poll()ed. By default it becomes readable on
+every frame, but with RC_IOC_SET_WAKEUP it can ask to be woken only
+when a channel moves past a threshold, the status changes, or a
+maximum interval passes, and for read() to block until then. The
+rules are checked in a work item after each frame and lost tick, so
+readers that are not due are never woken. Such a reader always reads
+the latest frame rather than the next one in the ring.
+
+For logging, RC_IOC_SET_FORMAT switches an open file to binary reads,
+which return every frame in order as fixed size struct rc_frame_record,
+as many as fit in one read() call.
 
-TODO: Right now it assumes SYS_CLK = 13MHz. Fix this assumption!
+Every frame is stamped with the CLOCK_MONOTONIC time of the start
+pulse edge that ended it, as taken by the backend's ISR. Binary
+records carry that time and the age of the frame when it was read, and
+RC_IOC_GET_STATUS returns the age of the latest frame, so a reader can
+allow for how stale its input is.
+
+Backends may feed two inputs (sources), e.g. redundant receivers.
+Each has its own decoder and link quality, and the decode path picks
+which one's frames are published: it stays with the active source
+until that goes a whole frame of the other without a good frame, or
+the other's link quality is clearly better, so failover takes less
+than a frame. The source of each frame is recorded, and the active
+one is in /sys/class/misc/rc/source and RC_IOC_GET_STATUS.
+
+A link quality figure from 0 to 100% (link_quality.c) is updated
+every frame from a sliding window of good, rejected and missing
+frames and from the jitter in the start pulses. It is in
+/sys/class/misc/rc/link_quality, and RC_IOC_GET_STATUS (rc_ioctl.h)
+returns it together with the status.
+
+The time of every start pulse also drives a frame clock (rc_clock.c),
+which estimates the frame period and phase and provides /dev/rc_clock
+for scheduling a control loop just after each frame arrives.
+
+The module can also generate PPM (rc_out.c). Frames written to
+/dev/rc_out are clocked out from an hrtimer on a GPIO, and can be
+looped back into the decoder as a second source for testing. With
+passthrough on, each published frame is forwarded to the output from
+the ISR, for a safety pilot to take over independently of userspace.
+Once the input is lost the output is handed back to userspace.
 */
 
 #include <linux/init.h>
@@ -27,113 +127,526 @@ TODO: Right now it assumes SYS_CLK = 13MHz. Fix this assumption!
 #include <linux/device.h>
 #include <linux/cdev.h>
 #include <linux/fs.h>
-#include <linux/gpio.h>
-#include <linux/clk.h>	
 #include <linux/miscdevice.h>
 #include <linux/jiffies.h>
-#include <mach/gpio.h>
-#include <plat/dmtimer.h>
-#include <asm/io.h>
 #include <asm/uaccess.h>
-#include <plat/mux.h>
 #include <linux/sched.h>
-#include "rc.h"
-#include "ring.h"
+#include <linux/rcupdate.h>
+#include <linux/spinlock.h>
+#include <linux/mutex.h>
+#include <linux/sysfs.h>
+#include <linux/math64.h>
+#include <linux/workqueue.h>
+#include <linux/seqlock.h>
+#include <linux/ktime.h>
+#include <linux/list.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include "rc_core.h"
+#include "rc_clock.h"
+#include "rc_ioctl.h"
+#include "link_quality.h"
+#include "rc_frames.h"
+#include "rc_input.h"
+#include "rc_iio.h"
+#include "rc_out.h"
+#include "frame_ring.h"
+#include "ppm.h"
 
 #define JIFFIES_TO_MILLISECONDS(x)		(((x) * 1000) / HZ)
-#define MAX_CHANNELS				20 
 
 #define RC_DEV_NAME				"rc"
-#define RC_PAD_ADDR				(0x2174 + 0x48000000 - OMAP34XX_PADCONF_START) /* This is GPIO_144 */
-#define RC_PAD_BIT				16 /* 144 - 128 = 16 */
-#define RC_PAD_NUM				144
-#define RC_PAD_BASE				OMAP34XX_GPIO5_REG_BASE /* Note: RC_PAD is GPIO_144 -> GPIO group 5 */
-
-#define PPM_START_MIN_10US			600 /* i.e. 6ms */			
-#define PPM_START_MAX_10US			1500 /* i.e. 15ms */			
-#define PRESCALE_DIV32				32
-#define TIMER_PRESCALE_DIV32		4 
 
-#define USER_BUFF_SIZE				128
+#define USER_BUFF_SIZE				256 /* "RC_REALLY_LOST" and 20 channels of up to 10 digits, as many as an unsigned int has */
 
 #define REALLY_LOST				20 /* i.e. 20 x 100ms = 2s */
 #define REALLY_LOST_MS          2000 /* i.e. 2s */
 
-typedef enum {DETECT_CHANNELS = 0, DECODE_PPM } rc_mode_t;
+#define RC_LOST_TICK_US			100000
+#define RC_SOURCE_HYSTERESIS			10 /* Link quality, in %, needed to switch to a source that is still running */
+
+typedef enum rc_status rc_status_t;
+
+static const char *rc_status_names[] = { "RC_OK", "RC_LOST", "RC_REALLY_LOST" };
+static const unsigned int rc_status_lens[] = { 5, 7, 14 };
 
 typedef struct
 {
-    char buffer[128];
-    ring_t ring;
-} rc_channel_t;
+    const char *name; /* Name of the preset this came from, or "custom" */
+    ppm_timing_t ppm; /* Limits on the gaps between edges */
+    rc_edge_t edge; /* Edge the gaps are measured between */
+    bool adaptive; /* Learn the limits from the signal instead of using ppm's */
+} rc_timing_t;
 
+/* Never modified once published. To change it, use rc_config_update() */
 typedef struct
 {
-    unsigned int padconf_reg; /* Store the value of this reg so it can later be returned */
-    unsigned int gpio_oe_reg; /* Store the value of this reg so it can later be returned */
-    unsigned int gpt_tclr_reg; /* Store the value of this reg so it can later be returned */
-    unsigned int ppm_irq;
-    unsigned int timer_irq;
-    unsigned int timer_zero_val;
+    unsigned int num_channels; /* 0 until channels have been detected */
+    rc_timing_t timing;
+    struct rcu_head rcu;
+} rc_config_t;
+
+static const rc_timing_t rc_profiles[] =
+{
+    /* Standard 22ms frame */
+    { "standard", { 6000, 15000, 500, 2500 }, RC_EDGE_FALLING },
+    /* Short frame high rate PPM, roughly twice the frame rate */
+    { "fast", { 2500, 6000, 400, 2300 }, RC_EDGE_FALLING },
+    /* Unknown transmitter, the standard limits are only placeholders */
+    { "adaptive", { 6000, 15000, 500, 2500 }, RC_EDGE_FALLING, true },
+};
+
+/* The values of one frame formatted as text, e.g. ",1020,1990\n" */
+typedef struct
+{
+    seqcount_t seqcount; /* Odd while being written */
+    unsigned int seq; /* Sequence number of the frame */
+    unsigned int len;
+    char buffer[USER_BUFF_SIZE];
+} rc_text_t;
+
+/* Decoding state of one PPM input */
+typedef struct
+{
+    ppm_decoder_t decoder; /* Only used from the backend's ISR for this input */
+    ppm_learner_t learner; /* Likewise, and only in adaptive mode */
+    link_quality_t link; /* Updated from the ISR and lost tick */
+    unsigned int frame_us; /* Time since the last start pulse */
     unsigned int lost_counter;
-    struct omap_dm_timer *timer_ptr;
-    unsigned int num_channels;
-    rc_channel_t *channel; /* Dynamically allocated */
-    rc_mode_t mode;
-    char user_buff[USER_BUFF_SIZE];
     unsigned int last_jiffies;
+    u64 last_frame_ns; /* Time of the last good frame, 0 if none */
+} rc_source_t;
+
+typedef struct
+{
+    const rc_backend_t *backend;
+    rc_source_t source[RC_MAX_SOURCES];
+    unsigned int active; /* Source whose frames are published */
+    spinlock_t source_lock; /* Serialises selection and publishing between inputs */
+    rc_config_t __rcu *config; /* Current decoder configuration */
+    spinlock_t config_lock; /* Serialises publishers of config, never taken by readers */
+    struct mutex timing_mutex; /* Serialises changes to the timing profile from sysfs */
+    frame_ring_t frames; /* Decoded frames, shared by all readers */
+    struct work_struct text_work; /* Formats each new frame into text */
+    struct work_struct wake_work; /* Wakes the readers that are due */
+    struct list_head readers; /* Every open file */
+    struct mutex readers_mutex; /* Protects readers */
+    rc_text_t text[2]; /* Double buffered, so the last two frames are cached */
+    unsigned int text_active; /* Index of the most recently formatted text */
 } rc_dev_t;
 
+typedef struct
+{
+    frame_cursor_t cursor; /* Position of this open file in rc_dev.frames */
+    char user_buff[USER_BUFF_SIZE];
+    struct list_head node; /* In rc_dev.readers */
+    wait_queue_head_t wait;
+    struct rc_wakeup wakeup; /* When to wake this reader */
+    enum rc_format format; /* What read() returns */
+    bool ready; /* Due to be woken, cleared by read */
+    /* What this reader saw at its last read, to compare against */
+    rc_status_t ref_status;
+    unsigned int ref_seq;
+    unsigned int ref_num_values;
+    unsigned int ref_value[FRAME_MAX_VALUES];
+    unsigned long ref_jiffies;
+} rc_reader_t;
+
 /* local variables */
 static rc_dev_t rc_dev;
 
-static ssize_t rc_read(struct file *file, char *buf, size_t count, loff_t *ppos)
-{	 
-    int len, i, j;
+static const rc_backend_t *rc_backends[] =
+{
+    &rc_gpio_backend,
+};
 
-    rc_dev.user_buff[0] = '\0';
+static char *backend = NULL;
+module_param(backend, charp, 0444);
+MODULE_PARM_DESC(backend, "Source of edges: \"gpio\" (default is the first built in)");
 
-    /* Status */
-    j = strlen(rc_dev.user_buff);
-    if(rc_dev.lost_counter == 0 && rc_dev.num_channels && rc_dev.mode != DETECT_CHANNELS)
+static void rc_config_free(struct rcu_head *head)
+{
+    kfree(container_of(head, rc_config_t, rcu));
+}
+
+/* Publishes a copy of the current configuration, with the timing
+   replaced if timing is not NULL and the number of channels replaced
+   if num_channels is not negative. The copy is made under config_lock
+   so a change from sysfs can not undo a change made by the ISR. Never
+   sleeps or waits for readers, so it is safe to call from the ISR. The
+   old configuration is freed once all readers have finished with it. */
+static int rc_config_update(const rc_timing_t *timing, int num_channels)
+{
+    rc_config_t *new_cfg, *old_cfg;
+    unsigned long flags;
+
+    new_cfg = kmalloc(sizeof(rc_config_t), GFP_ATOMIC);
+    if(new_cfg == NULL)
+        return -ENOMEM;
+
+    spin_lock_irqsave(&rc_dev.config_lock, flags);
+    old_cfg = rcu_dereference_protected(rc_dev.config, lockdep_is_held(&rc_dev.config_lock));
+    *new_cfg = *old_cfg;
+    if(timing != NULL)
+        new_cfg->timing = *timing;
+    if(num_channels >= 0)
+        new_cfg->num_channels = num_channels;
+    rcu_assign_pointer(rc_dev.config, new_cfg);
+    spin_unlock_irqrestore(&rc_dev.config_lock, flags);
+
+    call_rcu(&old_cfg->rcu, rc_config_free);
+
+    return 0;
+}
+
+static int rc_config_set_channels(const rc_config_t *cfg, unsigned int num_channels)
+{
+    if(cfg->num_channels == num_channels)
+        return 0;
+
+    return rc_config_update(NULL, num_channels);
+}
+
+static int rc_open(struct inode *inode, struct file *file)
+{
+    rc_reader_t *reader = kzalloc(sizeof(rc_reader_t), GFP_KERNEL);
+    if(reader == NULL)
+        return -ENOMEM;
+
+    frame_cursor_init(&rc_dev.frames, &reader->cursor);
+    init_waitqueue_head(&reader->wait);
+    reader->ref_status = RC_STATUS_REALLY_LOST;
+    reader->ref_seq = reader->cursor.seq;
+    reader->ref_jiffies = jiffies;
+    file->private_data = reader;
+
+    mutex_lock(&rc_dev.readers_mutex);
+    list_add_tail(&reader->node, &rc_dev.readers);
+    mutex_unlock(&rc_dev.readers_mutex);
+
+    return 0;
+}
+
+static int rc_release(struct inode *inode, struct file *file)
+{
+    rc_reader_t *reader = file->private_data;
+
+    mutex_lock(&rc_dev.readers_mutex);
+    list_del(&reader->node);
+    mutex_unlock(&rc_dev.readers_mutex);
+
+    kfree(reader);
+    return 0;
+}
+
+static rc_source_t *rc_active(void)
+{
+    return &rc_dev.source[READ_ONCE(rc_dev.active)];
+}
+
+/* Frames the active source's decoder has dropped since it was loaded */
+static unsigned int rc_rejected(void)
+{
+    const ppm_rejects_t *rejects = &rc_active()->decoder.rejects;
+
+    return READ_ONCE(rejects->bounds) + READ_ONCE(rejects->count) + READ_ONCE(rejects->length);
+}
+
+static rc_status_t rc_status(unsigned int num_channels)
+{
+    const rc_source_t *src = rc_active();
+
+    if(src->lost_counter == 0 && num_channels && src->decoder.mode != PPM_DETECT_CHANNELS)
     {
-        snprintf(rc_dev.user_buff + j, USER_BUFF_SIZE, "RC_OK");
+        return RC_STATUS_OK;
     }
-    else if(rc_dev.lost_counter < REALLY_LOST && rc_dev.num_channels && (rc_dev.mode != DETECT_CHANNELS || JIFFIES_TO_MILLISECONDS(jiffies - rc_dev.last_jiffies) < REALLY_LOST_MS))
+    else if(src->lost_counter < REALLY_LOST && num_channels && (src->decoder.mode != PPM_DETECT_CHANNELS || JIFFIES_TO_MILLISECONDS(jiffies - src->last_jiffies) < REALLY_LOST_MS))
     {
-        snprintf(rc_dev.user_buff + j, USER_BUFF_SIZE, "RC_LOST");
+        return RC_STATUS_LOST;
     }
     else /* REALLY_LOST */
     {
-        snprintf(rc_dev.user_buff + j, USER_BUFF_SIZE, "RC_REALLY_LOST");
+        return RC_STATUS_REALLY_LOST;
+    }
+}
+
+/* Formats the values of frame and the new line character */
+static unsigned int rc_format_values(const frame_t *frame, char *buffer, unsigned int size)
+{
+    unsigned int len = 0;
+    int i;
+
+    for(i = 0; i < frame->num_values; i++)
+    {
+        len += scnprintf(buffer + len, size - len, ",%u", frame->value[i]);
+    }
+    len += scnprintf(buffer + len, size - len, "\n");
+
+    return len;
+}
+
+/* Copies the most recently committed frame to frame, returning non-zero,
+   or returns zero if there is none */
+int rc_frame_latest(frame_t *frame)
+{
+    frame_cursor_t cursor;
+
+    frame_cursor_init(&rc_dev.frames, &cursor);
+    return frame_ring_read(&rc_dev.frames, &cursor, frame);
+}
+
+void rc_frame_cursor_init(frame_cursor_t *cursor)
+{
+    frame_cursor_init(&rc_dev.frames, cursor);
+}
+
+int rc_frame_read(frame_cursor_t *cursor, frame_t *frame)
+{
+    return frame_ring_read(&rc_dev.frames, cursor, frame);
+}
+
+/* Runs after each committed frame, outside the ISR */
+static void rc_text_work(struct work_struct *work)
+{
+    frame_t frame;
+    rc_text_t *text;
+
+    /* Only the latest frame is worth formatting */
+    if(!rc_frame_latest(&frame))
+        return;
+    if(rc_dev.text[rc_dev.text_active].seq == frame.seq)
+        return;
+
+    /* Overwrite the older of the two */
+    text = &rc_dev.text[!rc_dev.text_active];
+    write_seqcount_begin(&text->seqcount);
+    text->seq = frame.seq;
+    text->len = rc_format_values(&frame, text->buffer, sizeof(text->buffer));
+    write_seqcount_end(&text->seqcount);
+
+    WRITE_ONCE(rc_dev.text_active, !rc_dev.text_active);
+}
+
+/* Copies the cached text of frame seq to buffer, which has room for
+   size characters. Returns its length, or 0 if it is not cached, does
+   not fit, or was overwritten while copying. */
+static unsigned int rc_text_get(unsigned int seq, char *buffer, unsigned int size)
+{
+    unsigned int active = READ_ONCE(rc_dev.text_active);
+    int i;
+
+    for(i = 0; i < 2; i++)
+    {
+        const rc_text_t *text = &rc_dev.text[i ? !active : active];
+        unsigned int start = raw_read_seqcount(&text->seqcount);
+        unsigned int len;
+
+        if((start & 1) || text->seq != seq)
+            continue;
+
+        len = text->len;
+        if(len > size) /* Let the caller format what fits */
+            return 0;
+        memcpy(buffer, text->buffer, len);
+        if(!read_seqcount_retry(&text->seqcount, start))
+            return len;
     }
 
-    /* Values */
-    if(rc_dev.num_channels && rc_dev.lost_counter == 0)
+    return 0;
+}
+
+static unsigned int rc_num_channels(void)
+{
+    unsigned int num_channels;
+
+    rcu_read_lock();
+    num_channels = rcu_dereference(rc_dev.config)->num_channels;
+    rcu_read_unlock();
+
+    return num_channels;
+}
+
+/* Returns true if reader should be woken for frame and status */
+static bool rc_reader_due(const rc_reader_t *reader, const frame_t *frame, rc_status_t status)
+{
+    const struct rc_wakeup *wakeup = &reader->wakeup;
+    int i;
+
+    if(status != reader->ref_status)
+        return true;
+    if(wakeup->max_interval_ms && time_after_eq(jiffies, reader->ref_jiffies + msecs_to_jiffies(wakeup->max_interval_ms)))
+        return true;
+    if(frame == NULL || frame->seq == reader->ref_seq)
+        return false;
+    if(wakeup->threshold_us == 0 || reader->format == RC_FORMAT_BINARY || frame->num_values != reader->ref_num_values)
+        return true;
+
+    for(i = 0; i < frame->num_values; i++)
     {
-        if(!ring_empty_p(&rc_dev.channel[0].ring) && !ring_empty_p(&rc_dev.channel[rc_dev.num_channels-1].ring))
+        if(abs((int)frame->value[i] - (int)reader->ref_value[i]) >= wakeup->threshold_us)
+            return true;
+    }
+
+    return false;
+}
+
+/* Runs after each committed frame and each lost tick */
+static void rc_wake_work(struct work_struct *work)
+{
+    rc_status_t status = rc_status(rc_num_channels());
+    rc_reader_t *reader;
+    frame_t frame;
+    bool have_frame = rc_frame_latest(&frame);
+
+    mutex_lock(&rc_dev.readers_mutex);
+    list_for_each_entry(reader, &rc_dev.readers, node)
+    {
+        if(READ_ONCE(reader->ready))
+            continue;
+        if(rc_reader_due(reader, have_frame ? &frame : NULL, status))
         {
-            for(i = 0; i < rc_dev.num_channels; i++)
-            {
-                int val;
-                j = strlen(rc_dev.user_buff);
-                ring_read(&rc_dev.channel[i].ring, &val, sizeof(val));
-                snprintf(rc_dev.user_buff + j, USER_BUFF_SIZE, ",%d", val);
-            }
+            WRITE_ONCE(reader->ready, true);
+            wake_up_interruptible(&reader->wait);
         }
     }
+    mutex_unlock(&rc_dev.readers_mutex);
+}
 
-    /* New line character */
-    j = strlen(rc_dev.user_buff);
-    snprintf(rc_dev.user_buff + j, USER_BUFF_SIZE, "\n");
+/* Returns true if there is a frame reader has not read */
+static bool rc_reader_has_frame(const rc_reader_t *reader)
+{
+    return READ_ONCE(rc_dev.frames.head) != reader->cursor.seq;
+}
 
-    len = strlen(rc_dev.user_buff);
+/* Microseconds from time_ns to now_ns, saturated below RC_AGE_NONE */
+static u32 rc_frame_age_us(u64 time_ns, u64 now_ns)
+{
+    return min_t(u64, div_u64(now_ns - time_ns, NSEC_PER_USEC), RC_AGE_NONE - 1);
+}
 
-    if(count < len)
+static void rc_frame_to_record(const frame_t *frame, struct rc_frame_record *record, u64 now_ns)
+{
+    int i;
+
+    memset(record, 0, sizeof(*record));
+    record->time_ns = frame->time_ns;
+    record->age_us = rc_frame_age_us(frame->time_ns, now_ns);
+    record->seq = frame->seq;
+    record->num_channels = frame->num_values;
+    record->source = frame->source;
+    for(i = 0; i < frame->num_values; i++)
+        record->value_us[i] = frame->value[i];
+}
+
+/* read() in RC_FORMAT_BINARY, one record per frame not yet read */
+static ssize_t rc_read_records(rc_reader_t *reader, struct file *file, char __user *buf, size_t count)
+{
+    struct rc_frame_record record;
+    size_t len = 0;
+    frame_t frame;
+    u64 now_ns;
+
+    if(count < sizeof(record))
         return -EINVAL;
+
+    while(!rc_reader_has_frame(reader))
+    {
+        if(file->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+        /* wake_work sets ready again on the next frame */
+        WRITE_ONCE(reader->ready, false);
+        if(wait_event_interruptible(reader->wait, READ_ONCE(reader->ready) || rc_reader_has_frame(reader)))
+            return -ERESTARTSYS;
+    }
+    WRITE_ONCE(reader->ready, false);
+    reader->ref_jiffies = jiffies;
+    now_ns = ktime_get_ns();
+
+    while(len + sizeof(record) <= count && frame_ring_read(&rc_dev.frames, &reader->cursor, &frame))
+    {
+        rc_frame_to_record(&frame, &record, now_ns);
+        if(copy_to_user(buf + len, &record, sizeof(record)))
+            return len ? len : -EFAULT;
+        len += sizeof(record);
+        reader->ref_seq = frame.seq;
+    }
+
+    return len;
+}
+
+static ssize_t rc_read(struct file *file, char *buf, size_t count, loff_t *ppos)
+{	 
+    rc_reader_t *reader = file->private_data;
+    char *user_buff = reader->user_buff;
+    unsigned int num_channels, len;
+    rc_status_t status;
+
+    if(reader->format == RC_FORMAT_BINARY)
+        return rc_read_records(reader, file, buf, count);
+
     if(*ppos != 0)
         return 0;
-    if(copy_to_user(buf, rc_dev.user_buff, len))
+
+    if(reader->wakeup.flags & RC_WAKEUP_BLOCK)
+    {
+        if(!READ_ONCE(reader->ready) && (file->f_flags & O_NONBLOCK))
+            return -EAGAIN;
+        if(wait_event_interruptible(reader->wait, READ_ONCE(reader->ready)))
+            return -ERESTARTSYS;
+    }
+    WRITE_ONCE(reader->ready, false);
+    reader->ref_jiffies = jiffies;
+
+    /* A reader with a threshold wants where the sticks are now, not
+       the frames in between */
+    if(reader->wakeup.threshold_us)
+    {
+        frame_cursor_t latest;
+
+        frame_cursor_init(&rc_dev.frames, &latest);
+        if((int)(latest.seq - reader->cursor.seq) > 0)
+            reader->cursor.seq = latest.seq;
+    }
+
+    num_channels = rc_num_channels();
+
+    /* Status */
+    status = rc_status(num_channels);
+    reader->ref_status = status;
+    memcpy(user_buff, rc_status_names[status], rc_status_lens[status]);
+    len = rc_status_lens[status];
+
+    /* Values of the next frame this reader has not seen, and the new
+       line character */
+    if(num_channels && rc_active()->lost_counter == 0)
+    {
+        frame_t frame;
+        if(frame_ring_read(&rc_dev.frames, &reader->cursor, &frame))
+        {
+            unsigned int values_len;
+
+            reader->ref_seq = frame.seq;
+            reader->ref_num_values = frame.num_values;
+            memcpy(reader->ref_value, frame.value, frame.num_values * sizeof(frame.value[0]));
+
+            values_len = rc_text_get(frame.seq, user_buff + len, USER_BUFF_SIZE - len);
+            if(values_len == 0) /* Not cached, e.g. this reader is behind, or too long */
+                values_len = rc_format_values(&frame, user_buff + len, USER_BUFF_SIZE - len);
+            len += values_len;
+        }
+        else
+        {
+            user_buff[len++] = '\n';
+        }
+    }
+    else
+    {
+        user_buff[len++] = '\n';
+    }
+
+    if(count < len)
+        return -EINVAL;
+    if(copy_to_user(buf, user_buff, len))
         return -EINVAL;
 
     *ppos = len;
@@ -141,234 +654,657 @@ static ssize_t rc_read(struct file *file, char *buf, size_t count, loff_t *ppos)
     return len;
 }
 
+static __poll_t rc_poll(struct file *file, poll_table *wait)
+{
+    rc_reader_t *reader = file->private_data;
+
+    poll_wait(file, &reader->wait, wait);
+
+    return READ_ONCE(reader->ready) ? EPOLLIN | EPOLLRDNORM : 0;
+}
+
+static long rc_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    rc_reader_t *reader = file->private_data;
+    struct rc_status_info info;
+    struct rc_wakeup wakeup;
+    frame_t frame;
+    __u32 format;
+
+    switch(cmd)
+    {
+        case RC_IOC_SET_FORMAT:
+            if(get_user(format, (__u32 __user *)arg))
+                return -EFAULT;
+            if(format > RC_FORMAT_BINARY)
+                return -EINVAL;
+            mutex_lock(&rc_dev.readers_mutex);
+            reader->format = format;
+            mutex_unlock(&rc_dev.readers_mutex);
+            return 0;
+
+        case RC_IOC_SET_WAKEUP:
+            if(copy_from_user(&wakeup, (void __user *)arg, sizeof(wakeup)))
+                return -EFAULT;
+            if(wakeup.flags & ~RC_WAKEUP_BLOCK)
+                return -EINVAL;
+            mutex_lock(&rc_dev.readers_mutex);
+            reader->wakeup = wakeup;
+            mutex_unlock(&rc_dev.readers_mutex);
+            return 0;
+
+        case RC_IOC_GET_WAKEUP:
+            if(copy_to_user((void __user *)arg, &reader->wakeup, sizeof(reader->wakeup)))
+                return -EFAULT;
+            return 0;
+
+        case RC_IOC_GET_STATUS:
+            memset(&info, 0, sizeof(info));
+            info.num_channels = rc_num_channels();
+            info.status = rc_status(info.num_channels);
+            info.source = READ_ONCE(rc_dev.active);
+            info.link_quality = READ_ONCE(rc_dev.source[info.source].link.quality);
+            info.good_frames = READ_ONCE(rc_dev.source[info.source].link.good);
+            info.jitter_us = link_quality_jitter_us(&rc_dev.source[info.source].link);
+            info.frame_age_us = rc_frame_latest(&frame) ? rc_frame_age_us(frame.time_ns, ktime_get_ns()) : RC_AGE_NONE;
+            info.rejected_frames = rc_rejected();
+            info.lapped_frames = READ_ONCE(reader->cursor.lapped);
+            if(copy_to_user((void __user *)arg, &info, sizeof(info)))
+                return -EFAULT;
+            return 0;
+
+        default:
+            return -ENOTTY;
+    }
+}
+
 static const struct file_operations rc_fops = 
 {
     .owner = THIS_MODULE,
+    .open = rc_open,
+    .release = rc_release,
+    .llseek = default_llseek,
     .read = rc_read,
+    .poll = rc_poll,
+    .unlocked_ioctl = rc_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
 };
 
-static struct miscdevice rc_misc_dev = 
+static bool rc_timing_valid(const rc_timing_t *timing)
 {
-    MISC_DYNAMIC_MINOR,
-    RC_DEV_NAME,
-    &rc_fops
-};
+    return timing->ppm.pulse_min_us < timing->ppm.pulse_max_us
+        && timing->ppm.pulse_max_us <= timing->ppm.start_min_us
+        && timing->ppm.start_min_us < timing->ppm.start_max_us;
+}
 
-static unsigned int delta_10us(void)
+/* Validates timing and publishes it, changing the interrupt trigger
+   first if the edge has changed. Called with timing_mutex held. */
+static int rc_timing_apply(const rc_timing_t *timing)
 {
-    unsigned int reg = omap_dm_timer_read_counter(rc_dev.timer_ptr) - rc_dev.timer_zero_val;
-    omap_dm_timer_write_counter(rc_dev.timer_ptr, rc_dev.timer_zero_val);
+    rc_edge_t edge;
 
-    return reg >> 2; /* Approx (actually should be divided by 4.0625 rather than 4! Note 13MHz/DIV32 = 406250Hz */
+    if(!rc_timing_valid(timing))
+        return -EINVAL;
+
+    rcu_read_lock();
+    edge = rcu_dereference(rc_dev.config)->timing.edge;
+    rcu_read_unlock();
+
+    if(edge != timing->edge && rc_dev.backend->set_edge(timing->edge))
+        return -EINVAL;
+
+    return rc_config_update(timing, -1);
 }
 
-/* This isr is designed to overflow at 10Hz */
-static irqreturn_t timer_interrupt_handler(int irq, void *dev_id)
+static void rc_timing_get(rc_timing_t *timing)
 {
-    /* Reset the timer interrupt status */
-    omap_dm_timer_write_status(rc_dev.timer_ptr, OMAP_TIMER_INT_OVERFLOW);
-    omap_dm_timer_read_status(rc_dev.timer_ptr);
-    /* Increment the lost count, in seconds */
-    rc_dev.lost_counter++;
-    return IRQ_HANDLED;
+    rcu_read_lock();
+    *timing = rcu_dereference(rc_dev.config)->timing;
+    rcu_read_unlock();
 }
 
-static irqreturn_t ppm_interrupt_handler(int irq, void *dev_id)
+static ssize_t profile_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    static int pulse = 0;
-    unsigned int dt = delta_10us();
+    rc_timing_t timing;
 
-    if(dt > PPM_START_MAX_10US) /* Have encountered rather long frame. Need to re-detect channels */
-    {
-        pulse = 0;
-        rc_dev.num_channels = 0;
-        if(rc_dev.channel != NULL) /* De-allocate memory for channels... only if it has been allocated before! */
-        {
-            kfree(rc_dev.channel);
-            rc_dev.channel = NULL;
-        }
-        rc_dev.mode = DETECT_CHANNELS;
-    }
-
-    //printk(KERN_ERR "pulse: %d\n", pulse);
-    if(rc_dev.mode == DETECT_CHANNELS)
-    {
-        if(dt > PPM_START_MIN_10US && dt < PPM_START_MAX_10US) /* Have received a start pulse */
-        {		
-            if(pulse > 0) /* Have received a second start pulse -> change mode */
-            {
-                int i;
-                rc_dev.num_channels = pulse - 1;
-                rc_dev.channel = kmalloc(rc_dev.num_channels * sizeof(rc_channel_t), GFP_KERNEL); /* Allocate memory for channels */
-                if(rc_dev.channel == NULL)
-                {
-                    printk(KERN_ERR "kmalloc failed\n");
-                    return -1;
-                }
-                rc_dev.mode = DECODE_PPM;
-                rc_dev.lost_counter = 0;
-                for(i = 0; i < rc_dev.num_channels; i++)
-                {
-                    ring_init(&rc_dev.channel[i].ring, rc_dev.channel[i].buffer, sizeof(rc_dev.channel[i].buffer));
-                }
-
-                pulse = 0;
-            }
-            else
-            {
-                pulse = 1;
-            }
-        }
-        else if(dt < PPM_START_MIN_10US && pulse > 0) /* Have to first receive a start pulse */
-        {
-            pulse++;
-        }
-    }
-    else
+    rc_timing_get(&timing);
+    return sprintf(buf, "%s\n", timing.name);
+}
+
+static ssize_t profile_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    rc_timing_t timing;
+    bool vote;
+    int i, ret = -EINVAL;
+
+    for(i = 0; i < ARRAY_SIZE(rc_profiles); i++)
     {
-        if(dt > PPM_START_MIN_10US && dt < PPM_START_MAX_10US) /* Have received a start pulse */
-        {
-            pulse = 0;
-            rc_dev.last_jiffies = jiffies;
-        }
-        else if(pulse < rc_dev.num_channels)
-        {
-            ring_write_safe(&rc_dev.channel[pulse++].ring, &dt, sizeof(dt));
-        }
-        else
+        if(sysfs_streq(buf, rc_profiles[i].name))
         {
-            rc_dev.mode = DETECT_CHANNELS;
-            rc_dev.last_jiffies = jiffies;
+            mutex_lock(&rc_dev.timing_mutex);
+            rc_timing_get(&timing);
+            vote = timing.ppm.vote;
+            timing = rc_profiles[i];
+            /* Voting is not part of the profile, so keep it */
+            timing.ppm.vote = vote;
+            ret = rc_timing_apply(&timing);
+            mutex_unlock(&rc_dev.timing_mutex);
+            break;
         }
     }
 
-    return IRQ_HANDLED;
+    return ret ? ret : count;
 }
+static DEVICE_ATTR_RW(profile);
 
-static int rc_hardware_init(bool enable)
+static ssize_t edge_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
-    void __iomem *base;
+    rc_timing_t timing;
 
-    /* Configure mode of RC_PAD */
-    base = ioremap(OMAP34XX_PADCONF_START, OMAP34XX_PADCONF_SIZE);
-    if(base == NULL)
+    rc_timing_get(&timing);
+    return sprintf(buf, "%s\n", timing.edge == RC_EDGE_RISING ? "rising" : "falling");
+}
+
+static ssize_t edge_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    rc_timing_t timing;
+    int ret;
+
+    mutex_lock(&rc_dev.timing_mutex);
+    rc_timing_get(&timing);
+    if(!timing.adaptive)
+        timing.name = "custom";
+    if(sysfs_streq(buf, "rising"))
     {
-        printk(KERN_ERR "ioremap(PADCONF) failed\n");
-        return -1;
+        timing.edge = RC_EDGE_RISING;
+        ret = rc_timing_apply(&timing);
     }
-    if(enable)
+    else if(sysfs_streq(buf, "falling"))
     {
-        rc_dev.padconf_reg = ioread16(base + RC_PAD_ADDR);
-        iowrite16(PADCONF_IEN | PADCONF_PULL_UP | PADCONF_PULL_EN | PADCONF_GPIO_MODE, base + RC_PAD_ADDR);
+        timing.edge = RC_EDGE_FALLING;
+        ret = rc_timing_apply(&timing);
     }
-    else 
+    else
     {
-        iowrite16(rc_dev.padconf_reg, base + RC_PAD_ADDR);
+        ret = -EINVAL;
     }
-    iounmap(base);
+    mutex_unlock(&rc_dev.timing_mutex);
+
+    return ret ? ret : count;
+}
+static DEVICE_ATTR_RW(edge);
+
+/* Gets the timing in use, with the limits the active input has learned
+   in adaptive mode. Returns false if it has not learned them yet */
+static bool rc_timing_get_learned(rc_timing_t *timing)
+{
+    const ppm_learner_t *learner = &rc_active()->learner;
+
+    rc_timing_get(timing);
+    if(!timing->adaptive)
+        return true;
+    if(READ_ONCE(learner->state) != PPM_LEARNED)
+        return false;
+
+    /* Only updated by the ISR, so may be a frame out of date */
+    timing->ppm.start_min_us = READ_ONCE(learner->timing.start_min_us);
+    timing->ppm.start_max_us = READ_ONCE(learner->timing.start_max_us);
+    timing->ppm.pulse_min_us = READ_ONCE(learner->timing.pulse_min_us);
+    timing->ppm.pulse_max_us = READ_ONCE(learner->timing.pulse_max_us);
+    return true;
+}
+
+void rc_frame_limits(unsigned int *min_us, unsigned int *max_us)
+{
+    rc_timing_t timing;
+
+    /* Until adaptive timing is learned its placeholders are used */
+    rc_timing_get_learned(&timing);
+    *min_us = timing.ppm.pulse_min_us;
+    *max_us = timing.ppm.pulse_max_us;
+}
+
+static ssize_t rc_timing_field_show(char *buf, size_t offset)
+{
+    rc_timing_t timing;
+
+    if(!rc_timing_get_learned(&timing))
+        return sprintf(buf, "learning\n");
+    return sprintf(buf, "%u\n", *(unsigned int *)((char *)&timing + offset));
+}
+
+static ssize_t rc_timing_field_store(const char *buf, size_t count, size_t offset)
+{
+    rc_timing_t timing;
+    unsigned int us;
+    int ret;
 
-    /* Configure RC_PAD as input */
-    base = ioremap(RC_PAD_BASE, OMAP34XX_GPIO_REG_SIZE);
-    if(base == NULL)
+    ret = kstrtouint(buf, 0, &us);
+    if(ret)
+        return ret;
+
+    mutex_lock(&rc_dev.timing_mutex);
+    rc_timing_get_learned(&timing);
+    timing.name = "custom";
+    timing.adaptive = false;
+    *(unsigned int *)((char *)&timing + offset) = us;
+    ret = rc_timing_apply(&timing);
+    mutex_unlock(&rc_dev.timing_mutex);
+
+    return ret ? ret : count;
+}
+
+#define RC_TIMING_ATTR(field) \
+static ssize_t field##_us_show(struct device *dev, struct device_attribute *attr, char *buf) \
+{ \
+    return rc_timing_field_show(buf, offsetof(rc_timing_t, ppm.field##_us)); \
+} \
+static ssize_t field##_us_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count) \
+{ \
+    return rc_timing_field_store(buf, count, offsetof(rc_timing_t, ppm.field##_us)); \
+} \
+static DEVICE_ATTR_RW(field##_us)
+
+RC_TIMING_ATTR(start_min);
+RC_TIMING_ATTR(start_max);
+RC_TIMING_ATTR(pulse_min);
+RC_TIMING_ATTR(pulse_max);
+
+static ssize_t vote_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    rc_timing_t timing;
+
+    rc_timing_get(&timing);
+    return sprintf(buf, "%d\n", timing.ppm.vote);
+}
+
+/* Keeps the profile name, as voting is not part of the profile */
+static ssize_t vote_store(struct device *dev, struct device_attribute *attr, const char *buf, size_t count)
+{
+    rc_timing_t timing;
+    bool vote;
+    int ret;
+
+    ret = kstrtobool(buf, &vote);
+    if(ret)
+        return ret;
+
+    mutex_lock(&rc_dev.timing_mutex);
+    rc_timing_get(&timing);
+    timing.ppm.vote = vote;
+    ret = rc_timing_apply(&timing);
+    mutex_unlock(&rc_dev.timing_mutex);
+
+    return ret ? ret : count;
+}
+static DEVICE_ATTR_RW(vote);
+
+#define RC_REJECTED_ATTR(reason) \
+static ssize_t rejected_##reason##_show(struct device *dev, struct device_attribute *attr, char *buf) \
+{ \
+    return sprintf(buf, "%u\n", READ_ONCE(rc_active()->decoder.rejects.reason)); \
+} \
+static DEVICE_ATTR_RO(rejected_##reason)
+
+RC_REJECTED_ATTR(bounds);
+RC_REJECTED_ATTR(count);
+RC_REJECTED_ATTR(length);
+
+static ssize_t link_quality_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    return sprintf(buf, "%u\n", READ_ONCE(rc_active()->link.quality));
+}
+static DEVICE_ATTR_RO(link_quality);
+
+static ssize_t source_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    return sprintf(buf, "%u\n", READ_ONCE(rc_dev.active));
+}
+static DEVICE_ATTR_RO(source);
+
+static struct attribute *rc_attrs[] =
+{
+    &dev_attr_profile.attr,
+    &dev_attr_edge.attr,
+    &dev_attr_start_min_us.attr,
+    &dev_attr_start_max_us.attr,
+    &dev_attr_pulse_min_us.attr,
+    &dev_attr_pulse_max_us.attr,
+    &dev_attr_vote.attr,
+    &dev_attr_rejected_bounds.attr,
+    &dev_attr_rejected_count.attr,
+    &dev_attr_rejected_length.attr,
+    &dev_attr_link_quality.attr,
+    &dev_attr_source.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(rc);
+
+static struct miscdevice rc_misc_dev = 
+{
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = RC_DEV_NAME,
+    .fops = &rc_fops,
+    .groups = rc_groups,
+};
+
+/* Computes the multiplier and shift that convert ticks of a clock
+   running at rate_hz to microseconds. The shift is as large as possible
+   while still keeping the multiplier within 32 bits. */
+void rc_timebase_init(rc_timebase_t *tb, unsigned long rate_hz)
+{
+    u64 mult;
+    u32 shift = 32;
+
+    do
     {
-        printk(KERN_ERR "ioremap(GPIO_OE) failed\n");
-        return -1;
+        mult = div_u64(((u64)USEC_PER_SEC << shift) + rate_hz / 2, rate_hz);
     }
-    if(enable) 
-    {
-        rc_dev.gpio_oe_reg = ioread32(base + GPIO_OE_REG_OFFSET);
-        iowrite32(rc_dev.gpio_oe_reg & (~(0 << RC_PAD_BIT)), base + GPIO_OE_REG_OFFSET); 
+    while(mult > U32_MAX && --shift > 0);
 
-    }
-    else 
+    tb->mult = mult;
+    tb->shift = shift;
+}
+
+/* Called by the backend every 100ms while no edges arrive on source.
+   This may be from a timer on another CPU than the edge ISR, so the
+   source is updated under source_lock as rc_edge() does */
+void rc_lost_tick(unsigned int source)
+{
+    rc_source_t *src = &rc_dev.source[source];
+    unsigned long flags;
+    unsigned int period_us;
+
+    spin_lock_irqsave(&rc_dev.source_lock, flags);
+
+    /* Increment the lost count, in tenths of seconds */
+    src->lost_counter++;
+
+    /* Count the frames that should have arrived during the tick */
+    period_us = src->link.period_us;
+    link_quality_missed(&src->link, period_us ? RC_LOST_TICK_US / period_us : 1);
+
+    spin_unlock_irqrestore(&rc_dev.source_lock, flags);
+
+    if(source == READ_ONCE(rc_dev.active))
+        rc_out_lost();
+    schedule_work(&rc_dev.wake_work);
+}
+
+/* Decides whether a good frame from source should be published, switching to it if the active source has gone
+   quiet or is clearly worse. Called with source_lock held. */
+static bool rc_source_select(unsigned int source, const rc_config_t *cfg)
+{
+    rc_source_t *src = &rc_dev.source[source];
+    rc_source_t *act = &rc_dev.source[rc_dev.active];
+
+    if(source == rc_dev.active)
+        return true;
+
+    /* Switch if the active source has not had a good frame since the
+       previous one from this source, so failover is within a frame */
+    if(act->last_frame_ns >= src->last_frame_ns
+        && src->link.quality < act->link.quality + RC_SOURCE_HYSTERESIS)
+        return false;
+
+    if(cfg->num_channels != src->decoder.num_channels
+        && rc_config_set_channels(cfg, src->decoder.num_channels))
+        return false;
+
+    WRITE_ONCE(rc_dev.active, source);
+    return true;
+}
+
+/* Publishes the frame just decoded by src to every interface */
+static void rc_publish(rc_source_t *src, unsigned int source, ktime_t now)
+{
+    const ppm_decoder_t *dec = &src->decoder;
+    frame_t *frame;
+
+    /* Passthrough first, it is the one with a deadline */
+    rc_out_frame(dec->value, dec->num_channels);
+
+    frame = frame_ring_claim(&rc_dev.frames);
+    frame->num_values = dec->num_channels;
+    frame->source = source;
+    frame->time_ns = ktime_to_ns(now);
+    memcpy(frame->value, dec->value, dec->num_channels * sizeof(dec->value[0]));
+    frame_ring_commit(&rc_dev.frames);
+    schedule_work(&rc_dev.text_work);
+    schedule_work(&rc_dev.wake_work);
+    rc_input_frame();
+    rc_iio_frame();
+    rc_clock_sync(now);
+}
+
+/* Called by the backend, from its ISR, with the gap since the previous
+   edge on source and the time of this edge. Frames are stamped with the
+   time of the start pulse edge that ends them, not of when this runs */
+void rc_edge(unsigned int source, unsigned int dt, ktime_t now)
+{
+    rc_source_t *src = &rc_dev.source[source];
+    ppm_decoder_t *dec = &src->decoder;
+    const rc_config_t *cfg;
+    unsigned long flags;
+    ppm_event_t event;
+    bool active;
+
+    src->frame_us += dt;
+
+    rcu_read_lock();
+    cfg = rcu_dereference(rc_dev.config);
+
+    if(cfg->timing.adaptive)
+        event = ppm_decode_adaptive(dec, &src->learner, &cfg->timing.ppm, dt);
+    else
+        event = ppm_decode(dec, &cfg->timing.ppm, dt);
+    if(event == PPM_EVENT_NONE)
     {
-        iowrite32(rc_dev.gpio_oe_reg, base + GPIO_OE_REG_OFFSET);		
+        rcu_read_unlock();
+        return;
     }
-    iounmap(base);
 
-    /* Configure timer and its overflow interrupt */
-    if(enable)
+    spin_lock_irqsave(&rc_dev.source_lock, flags);
+    active = source == rc_dev.active;
+
+    switch(event)
     {
-        struct clk *gt_fclk;
-        rc_dev.timer_ptr = omap_dm_timer_request();
-        if(rc_dev.timer_ptr == NULL)
-        {
-            printk(KERN_ERR "omap_dm_timer_request failed\n");
-            return -1;	
-        }
+        case PPM_EVENT_FRAME:
+            link_quality_frame(&src->link, src->frame_us, dt, true);
+            src->frame_us = 0;
+            if(rc_source_select(source, cfg))
+                rc_publish(src, source, now);
+            src->last_frame_ns = ktime_to_ns(now);
+            src->last_jiffies = jiffies;
+            break;
+        case PPM_EVENT_SYNC:
+            link_quality_frame(&src->link, src->frame_us, dt, false);
+            src->frame_us = 0;
+            if(active)
+                rc_clock_sync(now);
+            src->last_jiffies = jiffies;
+            break;
+        case PPM_EVENT_DESYNC:
+            link_quality_missed(&src->link, 1);
+            src->last_jiffies = jiffies;
+            break;
+        case PPM_EVENT_LOCK:
+            src->frame_us = 0;
+            if(!active || rc_config_set_channels(cfg, dec->num_channels) == 0)
+                src->lost_counter = 0;
+            else /* Stay detecting and retry next frame */
+                ppm_decoder_unlock(dec);
+            break;
+        case PPM_EVENT_RESET:
+            src->frame_us = 0;
+            if(active)
+                rc_config_set_channels(cfg, 0);
+            break;
+        case PPM_EVENT_NONE:
+            break;
+    }
 
-        omap_dm_timer_set_source(rc_dev.timer_ptr, OMAP_TIMER_SRC_SYS_CLK);
-        omap_dm_timer_set_prescaler(rc_dev.timer_ptr, TIMER_PRESCALE_DIV32);
-        rc_dev.timer_irq = omap_dm_timer_get_irq(rc_dev.timer_ptr);
+    spin_unlock_irqrestore(&rc_dev.source_lock, flags);
+    rcu_read_unlock();
+}
 
-        if(request_irq(rc_dev.timer_irq, timer_interrupt_handler, IRQF_DISABLED | IRQF_TIMER , RC_DEV_NAME, timer_interrupt_handler))
-        {
-            printk(KERN_ERR "request_irq failed (timer)\n");
-            return -1;
-        }
-        gt_fclk = omap_dm_timer_get_fclk(rc_dev.timer_ptr);
-        rc_dev.timer_zero_val = 0xFFFFFFFF - (clk_get_rate(gt_fclk) / (PRESCALE_DIV32 * 10)); // divide by extra 10 to make ISR interrupt at 10Hz
-        omap_dm_timer_set_load(rc_dev.timer_ptr, 1, rc_dev.timer_zero_val);
-        omap_dm_timer_set_int_enable(rc_dev.timer_ptr, OMAP_TIMER_INT_OVERFLOW);
-        omap_dm_timer_start(rc_dev.timer_ptr);
-    }
-    else
+/* Frees the configuration, and any it replaced, once nothing is left
+   that could replace it: sysfs, the readers and the work items */
+static void rc_config_exit(void)
+{
+    cancel_work_sync(&rc_dev.text_work);
+    cancel_work_sync(&rc_dev.wake_work);
+
+    /* No more readers or publishers, so wait for any pending frees */
+    rcu_barrier();
+    kfree(rcu_dereference_protected(rc_dev.config, 1));
+}
+
+static int __init rc_init(void)
+{
+    int ret;
+    rc_config_t *cfg;
+    rc_edge_t edge;
+    int i;
+
+    BUILD_BUG_ON(PPM_MAX_CHANNELS > FRAME_MAX_VALUES);
+    BUILD_BUG_ON(LINK_QUALITY_WINDOW != RC_LINK_WINDOW);
+    BUILD_BUG_ON(FRAME_MAX_VALUES > RC_RECORD_MAX_CHANNELS);
+
+    /* Pick the backend */
+    rc_dev.backend = rc_backends[0];
+    for(i = 0; backend != NULL && i < ARRAY_SIZE(rc_backends); i++)
     {
-        omap_dm_timer_stop(rc_dev.timer_ptr);
-        free_irq(rc_dev.timer_irq, timer_interrupt_handler); 
-        omap_dm_timer_free(rc_dev.timer_ptr);
+        if(strcmp(backend, rc_backends[i]->name) == 0)
+            break;
     }
-
-    /* Configure interrupt */
-    if(enable)
+    if(backend != NULL)
     {
-        if(request_irq(rc_dev.ppm_irq, ppm_interrupt_handler, IRQF_TRIGGER_FALLING, RC_DEV_NAME, &rc_dev))
+        if(i == ARRAY_SIZE(rc_backends))
         {
-            printk(KERN_ERR "request_irq failed (io)\n");
-            return -1;
+            printk(KERN_ERR "Unknown backend \"%s\"\n", backend);
+            return -EINVAL;
         }
+        rc_dev.backend = rc_backends[i];
     }
-    else
+
+    /* Setup rc_dev structure, starting with the standard profile */
+    spin_lock_init(&rc_dev.config_lock);
+    mutex_init(&rc_dev.timing_mutex);
+    cfg = kzalloc(sizeof(rc_config_t), GFP_KERNEL);
+    if(cfg == NULL)
+    {
+        printk(KERN_ERR "Unable to allocate configuration\n");
+        return -ENOMEM;
+    }
+    cfg->timing = rc_profiles[0];
+    RCU_INIT_POINTER(rc_dev.config, cfg);
+    frame_ring_init(&rc_dev.frames);
+    INIT_WORK(&rc_dev.text_work, rc_text_work);
+    INIT_WORK(&rc_dev.wake_work, rc_wake_work);
+    INIT_LIST_HEAD(&rc_dev.readers);
+    mutex_init(&rc_dev.readers_mutex);
+    for(i = 0; i < 2; i++)
     {
-        free_irq(rc_dev.ppm_irq, &rc_dev); 
+        seqcount_init(&rc_dev.text[i].seqcount);
+        rc_dev.text[i].seq = ~0;
+        rc_dev.text[i].len = 0;
     }
+    rc_dev.text_active = 0;
+    for(i = 0; i < RC_MAX_SOURCES; i++)
+    {
+        rc_source_t *src = &rc_dev.source[i];
 
-    return 0;
-}
+        ppm_decoder_init(&src->decoder);
+        ppm_learner_init(&src->learner);
+        link_quality_init(&src->link);
+        src->frame_us = 0;
+        src->lost_counter = 0;
+        src->last_jiffies = 0;
+        src->last_frame_ns = 0;
+    }
+    rc_dev.active = 0;
+    spin_lock_init(&rc_dev.source_lock);
 
-static int __init rc_init(void)
-{
-    unsigned int ret = misc_register(&rc_misc_dev);
+    ret = misc_register(&rc_misc_dev);
     if(ret)
     {
         printk(KERN_ERR "Unable to register \"rc\" misc device\n");
-        return -1;
+        rc_config_exit();
+        return ret;
     }
 
-    /* Setup rc_dev structure */
-    rc_dev.ppm_irq = gpio_to_irq(RC_PAD_NUM);
-    rc_dev.num_channels = 0;
-    rc_dev.channel = NULL;
-    rc_dev.mode = DETECT_CHANNELS;
-    rc_dev.lost_counter = 0;
-    rc_dev.last_jiffies = 0;
+    /* From here on sysfs can replace the configuration, so it is only
+       freed as rc_exit() frees it */
+    ret = rc_clock_init();
+    if(ret)
+    {
+        misc_deregister(&rc_misc_dev);
+        rc_config_exit();
+        return ret;
+    }
+    ret = rc_input_init();
+    if(ret)
+    {
+        rc_clock_exit();
+        misc_deregister(&rc_misc_dev);
+        rc_config_exit();
+        return ret;
+    }
+    ret = rc_iio_init(rc_misc_dev.this_device);
+    if(ret)
+    {
+        rc_input_exit();
+        rc_clock_exit();
+        misc_deregister(&rc_misc_dev);
+        rc_config_exit();
+        return ret;
+    }
+    ret = rc_out_init();
+    if(ret)
+    {
+        rc_iio_exit();
+        rc_input_exit();
+        rc_clock_exit();
+        misc_deregister(&rc_misc_dev);
+        rc_config_exit();
+        return ret;
+    }
 
-    /* Setup hardware */
-    ret = rc_hardware_init(true);
+    /* Setup hardware, with the edge as sysfs may have changed it by now.
+       The mutex keeps it from changing until the backend is running */
+    mutex_lock(&rc_dev.timing_mutex);
+    rcu_read_lock();
+    edge = rcu_dereference(rc_dev.config)->timing.edge;
+    rcu_read_unlock();
+    ret = rc_dev.backend->init(edge);
+    mutex_unlock(&rc_dev.timing_mutex);
+    if(ret)
+    {
+        printk(KERN_ERR "Unable to start \"%s\" backend\n", rc_dev.backend->name);
+        rc_out_exit();
+        rc_iio_exit();
+        rc_input_exit();
+        rc_clock_exit();
+        misc_deregister(&rc_misc_dev);
+        rc_config_exit();
+    }
 
     return ret;
 }
 
 static void __exit rc_exit(void)
 {
+    /* Stop the edges first, including any looped back from the output,
+       then the interfaces fed by them. The IIO device is registered
+       under /dev/rc, so that goes last */
+    rc_out_exit();
+    rc_dev.backend->exit();
+    rc_iio_exit();
+    rc_input_exit();
+    rc_clock_exit();
     misc_deregister(&rc_misc_dev);	
-    /* Return RC_PAD to its original state */
-    rc_hardware_init(false);
-
-    if(rc_dev.channel != NULL)
-    {
-        kfree(rc_dev.channel);
-    }
+    rc_config_exit();
 }
 
 module_init(rc_init);
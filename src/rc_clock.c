@@ -0,0 +1,289 @@
+/*
+   ENEL675 - Advanced Embedded Systems
+File: 		rc_clock.c
+Author: 	agent
+Date:  		19 October 2026
+
+Frame clock for scheduling a control loop off the PPM input. The
+time of every start pulse is fed into a small PLL (frame_clock.c),
+which estimates the frame period and predicts when the next frame
+will arrive.
+
+The estimate is in /sys/class/misc/rc_clock/ (period_ns, next_ns,
+locked, slips). /dev/rc_clock works like a timerfd: each open file
+fires at the predicted time of every frame plus its own offset, set
+with RC_CLOCK_IOC_SET_OFFSET (see rc_ioctl.h). read() blocks until
+it has fired and returns the number of times it fired since the last
+read as a u64, and poll() reports when it is readable. While no start
+pulses arrive it carries on firing at the last estimated period.
+*/
+
+#include <linux/module.h>
+#include <linux/slab.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/device.h>
+#include <linux/sysfs.h>
+#include <linux/spinlock.h>
+#include <linux/hrtimer.h>
+#include <linux/ktime.h>
+#include <linux/wait.h>
+#include <linux/poll.h>
+#include <linux/uaccess.h>
+#include "frame_clock.h"
+#include "rc_clock.h"
+#include "rc_ioctl.h"
+
+#define RC_CLOCK_DEV_NAME			"rc_clock"
+#define RC_CLOCK_PERIOD_NS			22500000 /* Assumed until measured */
+#define RC_CLOCK_OFFSET_MAX_NS		NSEC_PER_SEC
+
+typedef struct
+{
+    frame_clock_t pll;
+    spinlock_t lock; /* Held for a copy of pll, the ISR may be threaded */
+} rc_clock_t;
+
+typedef struct
+{
+    struct hrtimer timer;
+    wait_queue_head_t wait;
+    spinlock_t lock; /* Protects expirations */
+    u64 expirations; /* Times fired since the last read */
+    s64 offset_ns;
+} rc_clock_reader_t;
+
+/* local variables */
+static rc_clock_t rc_clock;
+
+static void rc_clock_get(frame_clock_t *pll)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&rc_clock.lock, flags);
+    *pll = rc_clock.pll;
+    spin_unlock_irqrestore(&rc_clock.lock, flags);
+}
+
+/* Called from the ISR at each start pulse */
+void rc_clock_sync(ktime_t t)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&rc_clock.lock, flags);
+    frame_clock_sync(&rc_clock.pll, ktime_to_ns(t));
+    spin_unlock_irqrestore(&rc_clock.lock, flags);
+}
+
+/* The next time after now that reader should fire */
+static ktime_t rc_clock_next_expiry(const rc_clock_reader_t *reader)
+{
+    frame_clock_t pll;
+    s64 offset_ns = READ_ONCE(reader->offset_ns);
+
+    rc_clock_get(&pll);
+    return ns_to_ktime(frame_clock_next(&pll, ktime_get_ns() - offset_ns) + offset_ns);
+}
+
+static enum hrtimer_restart rc_clock_timer(struct hrtimer *timer)
+{
+    rc_clock_reader_t *reader = container_of(timer, rc_clock_reader_t, timer);
+
+    spin_lock(&reader->lock);
+    reader->expirations++;
+    spin_unlock(&reader->lock);
+    wake_up_interruptible(&reader->wait);
+
+    /* Follow the latest estimate rather than adding a period, so any
+       correction from the PLL applies from the next frame */
+    hrtimer_set_expires(timer, rc_clock_next_expiry(reader));
+
+    return HRTIMER_RESTART;
+}
+
+static int rc_clock_open(struct inode *inode, struct file *file)
+{
+    rc_clock_reader_t *reader = kzalloc(sizeof(rc_clock_reader_t), GFP_KERNEL);
+    if(reader == NULL)
+        return -ENOMEM;
+
+    init_waitqueue_head(&reader->wait);
+    spin_lock_init(&reader->lock);
+    hrtimer_init(&reader->timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS);
+    reader->timer.function = rc_clock_timer;
+    hrtimer_start(&reader->timer, rc_clock_next_expiry(reader), HRTIMER_MODE_ABS);
+    file->private_data = reader;
+
+    return 0;
+}
+
+static int rc_clock_release(struct inode *inode, struct file *file)
+{
+    rc_clock_reader_t *reader = file->private_data;
+
+    hrtimer_cancel(&reader->timer);
+    kfree(reader);
+    return 0;
+}
+
+static ssize_t rc_clock_read(struct file *file, char *buf, size_t count, loff_t *ppos)
+{
+    rc_clock_reader_t *reader = file->private_data;
+    u64 expirations;
+    int ret;
+
+    if(count < sizeof(expirations))
+        return -EINVAL;
+
+    for(;;)
+    {
+        spin_lock_irq(&reader->lock);
+        expirations = reader->expirations;
+        reader->expirations = 0;
+        spin_unlock_irq(&reader->lock);
+
+        if(expirations)
+            break;
+        if(file->f_flags & O_NONBLOCK)
+            return -EAGAIN;
+
+        ret = wait_event_interruptible(reader->wait, READ_ONCE(reader->expirations) != 0);
+        if(ret)
+            return ret;
+    }
+
+    if(copy_to_user(buf, &expirations, sizeof(expirations)))
+        return -EFAULT;
+
+    return sizeof(expirations);
+}
+
+static __poll_t rc_clock_poll(struct file *file, poll_table *wait)
+{
+    rc_clock_reader_t *reader = file->private_data;
+
+    poll_wait(file, &reader->wait, wait);
+
+    return READ_ONCE(reader->expirations) ? EPOLLIN | EPOLLRDNORM : 0;
+}
+
+static long rc_clock_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    rc_clock_reader_t *reader = file->private_data;
+    struct rc_clock_state state;
+    frame_clock_t pll;
+    s64 offset_ns;
+
+    switch(cmd)
+    {
+        case RC_CLOCK_IOC_SET_OFFSET:
+            if(copy_from_user(&offset_ns, (void __user *)arg, sizeof(offset_ns)))
+                return -EFAULT;
+            if(offset_ns < 0 || offset_ns > RC_CLOCK_OFFSET_MAX_NS)
+                return -EINVAL;
+
+            hrtimer_cancel(&reader->timer);
+            WRITE_ONCE(reader->offset_ns, offset_ns);
+            hrtimer_start(&reader->timer, rc_clock_next_expiry(reader), HRTIMER_MODE_ABS);
+            return 0;
+
+        case RC_CLOCK_IOC_GET_STATE:
+            rc_clock_get(&pll);
+            memset(&state, 0, sizeof(state));
+            state.period_ns = pll.period_ns;
+            state.next_ns = frame_clock_next(&pll, ktime_get_ns());
+            state.locked = frame_clock_locked(&pll);
+            state.slips = pll.slips;
+            if(copy_to_user((void __user *)arg, &state, sizeof(state)))
+                return -EFAULT;
+            return 0;
+
+        default:
+            return -ENOTTY;
+    }
+}
+
+static const struct file_operations rc_clock_fops =
+{
+    .owner = THIS_MODULE,
+    .open = rc_clock_open,
+    .release = rc_clock_release,
+    .read = rc_clock_read,
+    .poll = rc_clock_poll,
+    .unlocked_ioctl = rc_clock_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .llseek = noop_llseek,
+};
+
+static ssize_t period_ns_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    frame_clock_t pll;
+
+    rc_clock_get(&pll);
+    return sprintf(buf, "%lld\n", pll.period_ns);
+}
+static DEVICE_ATTR_RO(period_ns);
+
+static ssize_t next_ns_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    frame_clock_t pll;
+
+    rc_clock_get(&pll);
+    return sprintf(buf, "%lld\n", frame_clock_next(&pll, ktime_get_ns()));
+}
+static DEVICE_ATTR_RO(next_ns);
+
+static ssize_t locked_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    frame_clock_t pll;
+
+    rc_clock_get(&pll);
+    return sprintf(buf, "%d\n", frame_clock_locked(&pll));
+}
+static DEVICE_ATTR_RO(locked);
+
+static ssize_t slips_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    frame_clock_t pll;
+
+    rc_clock_get(&pll);
+    return sprintf(buf, "%u\n", pll.slips);
+}
+static DEVICE_ATTR_RO(slips);
+
+static struct attribute *rc_clock_attrs[] =
+{
+    &dev_attr_period_ns.attr,
+    &dev_attr_next_ns.attr,
+    &dev_attr_locked.attr,
+    &dev_attr_slips.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(rc_clock);
+
+static struct miscdevice rc_clock_misc_dev =
+{
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = RC_CLOCK_DEV_NAME,
+    .fops = &rc_clock_fops,
+    .groups = rc_clock_groups,
+};
+
+int rc_clock_init(void)
+{
+    int ret;
+
+    spin_lock_init(&rc_clock.lock);
+    frame_clock_init(&rc_clock.pll, RC_CLOCK_PERIOD_NS);
+
+    ret = misc_register(&rc_clock_misc_dev);
+    if(ret)
+        printk(KERN_ERR "Unable to register \"%s\" misc device\n", RC_CLOCK_DEV_NAME);
+
+    return ret;
+}
+
+void rc_clock_exit(void)
+{
+    misc_deregister(&rc_clock_misc_dev);
+}
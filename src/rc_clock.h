@@ -0,0 +1,13 @@
+#ifndef RC_CLOCK_H
+#define RC_CLOCK_H
+
+/* The frame clock (rc_clock.c). rc.c feeds it the time of every start
+   pulse, and it provides /dev/rc_clock. */
+
+extern int rc_clock_init(void);
+extern void rc_clock_exit(void);
+
+/* Called from the ISR at each start pulse */
+extern void rc_clock_sync(ktime_t t);
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef RC_CORE_H
+#define RC_CORE_H
+
+/* Interface between the decoder core (rc.c) and the hardware backends
+   that feed it edges. A backend measures the time between consecutive
+   edges of the PPM input and calls rc_edge() for each one, with the
+   ktime_get() time of the edge taken as early as it can, and calls
+   rc_lost_tick() every 100ms for as long as no edges arrive. A backend
+   with redundant inputs numbers them from 0 up to RC_MAX_SOURCES - 1,
+   and the core picks between them. */
+
+#define RC_MAX_SOURCES 2
+
+typedef enum {RC_EDGE_FALLING = 0, RC_EDGE_RISING } rc_edge_t;
+
+typedef struct
+{
+    const char *name;
+    int (*init)(rc_edge_t edge); /* Claim the input and start feeding edges */
+    void (*exit)(void); /* Stop feeding edges and release the input */
+    int (*set_edge)(rc_edge_t edge); /* Change the edge the gaps are measured between */
+} rc_backend_t;
+
+/* Converts counter ticks to microseconds with a multiply and a shift,
+   so the ISR never divides. Set up once from the real clock rate. */
+typedef struct
+{
+    u32 mult;
+    u32 shift;
+} rc_timebase_t;
+
+extern void rc_timebase_init(rc_timebase_t *tb, unsigned long rate_hz);
+
+static inline unsigned int rc_timebase_us(const rc_timebase_t *tb, u32 ticks)
+{
+    return mul_u64_u32_shr(ticks, tb->mult, tb->shift);
+}
+
+/* Called by backends, from interrupt context. Edges from one source
+   must not be reported concurrently, but different sources may be. */
+extern void rc_edge(unsigned int source, unsigned int dt_us, ktime_t t);
+extern void rc_lost_tick(unsigned int source);
+
+extern const rc_backend_t rc_gpio_backend;
+
+static inline unsigned int rc_edge_irq_type(rc_edge_t edge)
+{
+    return edge == RC_EDGE_RISING ? IRQ_TYPE_EDGE_RISING : IRQ_TYPE_EDGE_FALLING;
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef RC_FRAMES_H
+#define RC_FRAMES_H
+
+/* Frames committed by the core (rc.c), for its other interfaces such
+   as rc_input.c and rc_iio.c. Safe to call from any context. */
+
+#include "frame_ring.h"
+
+/* Copies the most recently committed frame to frame, returning
+   non-zero, or returns zero if there is none */
+extern int rc_frame_latest(frame_t *frame);
+
+/* The range a decoded value can take, the pulse limits of the timing
+   in use. In adaptive mode these are the learned ones once learned. */
+extern void rc_frame_limits(unsigned int *min_us, unsigned int *max_us);
+
+/* A private cursor, for an interface that needs every frame */
+extern void rc_frame_cursor_init(frame_cursor_t *cursor);
+extern int rc_frame_read(frame_cursor_t *cursor, frame_t *frame);
+
+#endif
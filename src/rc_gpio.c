@@ -0,0 +1,294 @@
+/*
+   ENEL675 - Advanced Embedded Systems
+File: 		rc_gpio.c
+Authors: 	Robert Tang, John Howe
+Date:  		11 September 2010
+
+gpiolib backend for the PPM decoder. Works with any GPIO that can
+interrupt, including the kernel's gpio-sim, so the decoder can be
+loaded and benchmarked on a host as well as on the board. Edges
+are timestamped with ktime_get() and the 10Hz lost signal tick
+comes from a kernel timer.
+
+The input is the "ppm" GPIO of an "rc-ppm" platform device, which
+is normally described in the device tree:
+
+    rc {
+        compatible = "rc-decoder,ppm";
+        ppm-gpios = <&gpio5 16 GPIO_ACTIVE_HIGH>;
+    };
+
+On machines without one, such as an x86 host using gpio-sim, the
+gpio_chip and gpio_line module parameters name the line instead and
+the platform device is created here, e.g.
+
+    insmod rc_decoder.ko backend=gpio gpio_chip=gpio-sim.0-node0 gpio_line=0
+
+A second "ppm" GPIO, from a redundant receiver, is decoded as source 1
+and the core picks between the two. In the device tree list both in
+ppm-gpios; with the module parameters add gpio_line2.
+*/
+
+#include <linux/module.h>
+#include <linux/interrupt.h>
+#include <linux/irq.h>
+#include <linux/gpio/consumer.h>
+#include <linux/gpio/machine.h>
+#include <linux/platform_device.h>
+#include <linux/of.h>
+#include <linux/ktime.h>
+#include <linux/jiffies.h>
+#include <linux/timer.h>
+#include "rc_core.h"
+
+#define RC_DEV_NAME				"rc"
+#define RC_GPIO_DRV_NAME			"rc-ppm"
+#define RC_GPIO_LOST_MS				100 /* i.e. lost tick at 10Hz */
+
+typedef struct
+{
+    struct gpio_desc *gpio;
+    unsigned int irq;
+    unsigned int source; /* Passed to rc_edge() */
+    ktime_t last_edge;
+    unsigned long last_edge_jiffies;
+} rc_gpio_line_t;
+
+typedef struct
+{
+    struct platform_device *pdev; /* Only set if created from the module parameters */
+    rc_gpio_line_t line[RC_MAX_SOURCES];
+    unsigned int num_lines;
+    rc_timebase_t timebase; /* Nanoseconds to microseconds */
+    struct timer_list lost_timer;
+    rc_edge_t edge; /* Edge to trigger on when probed */
+    bool probed;
+} rc_gpio_t;
+
+/* local variables */
+static rc_gpio_t rc_gpio;
+
+static char *gpio_chip;
+module_param(gpio_chip, charp, 0444);
+MODULE_PARM_DESC(gpio_chip, "Label of the GPIO chip with the PPM input, if not in the device tree");
+
+static unsigned int gpio_line;
+module_param(gpio_line, uint, 0444);
+MODULE_PARM_DESC(gpio_line, "Line of gpio_chip with the PPM input");
+
+static int gpio_line2 = -1;
+module_param(gpio_line2, int, 0444);
+MODULE_PARM_DESC(gpio_line2, "Line of gpio_chip with a second, redundant PPM input (default none)");
+
+static struct gpiod_lookup_table rc_gpio_lookup =
+{
+    .dev_id = RC_GPIO_DRV_NAME,
+    .table =
+    {
+        { }, /* Filled in from gpio_chip and gpio_line */
+        { }, /* and gpio_line2 */
+        { },
+    },
+};
+
+static irqreturn_t rc_gpio_interrupt_handler(int irq, void *dev_id)
+{
+    rc_gpio_line_t *line = dev_id;
+    ktime_t now = ktime_get();
+    s64 dt_ns = ktime_to_ns(ktime_sub(now, line->last_edge));
+
+    line->last_edge = now;
+    line->last_edge_jiffies = jiffies;
+
+    /* Anything longer than the lost tick is just a very long gap */
+    if(dt_ns > RC_GPIO_LOST_MS * NSEC_PER_MSEC)
+        dt_ns = RC_GPIO_LOST_MS * NSEC_PER_MSEC;
+
+    rc_edge(line->source, rc_timebase_us(&rc_gpio.timebase, dt_ns), now);
+
+    return IRQ_HANDLED;
+}
+
+/* Ticks at 10Hz, but only reports lost while no edges are arriving */
+static void rc_gpio_lost_timer(struct timer_list *t)
+{
+    unsigned long lost_jiffies = msecs_to_jiffies(RC_GPIO_LOST_MS);
+    int i;
+
+    for(i = 0; i < rc_gpio.num_lines; i++)
+    {
+        if(time_after_eq(jiffies, READ_ONCE(rc_gpio.line[i].last_edge_jiffies) + lost_jiffies))
+            rc_lost_tick(rc_gpio.line[i].source);
+    }
+
+    mod_timer(&rc_gpio.lost_timer, jiffies + lost_jiffies);
+}
+
+static int rc_gpio_probe(struct platform_device *pdev)
+{
+    int i, ret, count;
+
+    count = gpiod_count(&pdev->dev, "ppm");
+    if(count <= 0)
+    {
+        printk(KERN_ERR "Unable to get \"ppm\" gpio\n");
+        return count ? count : -ENOENT;
+    }
+    rc_gpio.num_lines = min(count, RC_MAX_SOURCES);
+
+    for(i = 0; i < rc_gpio.num_lines; i++)
+    {
+        rc_gpio_line_t *line = &rc_gpio.line[i];
+
+        line->gpio = devm_gpiod_get_index(&pdev->dev, "ppm", i, GPIOD_IN);
+        if(IS_ERR(line->gpio))
+        {
+            printk(KERN_ERR "Unable to get \"ppm\" gpio %d\n", i);
+            return PTR_ERR(line->gpio);
+        }
+
+        ret = gpiod_to_irq(line->gpio);
+        if(ret < 0)
+        {
+            printk(KERN_ERR "gpiod_to_irq failed\n");
+            return ret;
+        }
+        line->irq = ret;
+        line->source = i;
+        line->last_edge = ktime_get();
+        line->last_edge_jiffies = jiffies;
+    }
+
+    timer_setup(&rc_gpio.lost_timer, rc_gpio_lost_timer, 0);
+    mod_timer(&rc_gpio.lost_timer, jiffies + msecs_to_jiffies(RC_GPIO_LOST_MS));
+
+    for(i = 0; i < rc_gpio.num_lines; i++)
+    {
+        /* gpio-sim and gpio expanders may only offer nested interrupts */
+        ret = request_any_context_irq(rc_gpio.line[i].irq, rc_gpio_interrupt_handler, rc_edge_irq_type(rc_gpio.edge), RC_DEV_NAME, &rc_gpio.line[i]);
+        if(ret < 0)
+        {
+            printk(KERN_ERR "request_irq failed (gpio)\n");
+            while(--i >= 0)
+                free_irq(rc_gpio.line[i].irq, &rc_gpio.line[i]);
+            del_timer_sync(&rc_gpio.lost_timer);
+            return ret;
+        }
+    }
+
+    rc_gpio.probed = true;
+
+    return 0;
+}
+
+static int rc_gpio_remove(struct platform_device *pdev)
+{
+    int i;
+
+    for(i = 0; i < rc_gpio.num_lines; i++)
+        free_irq(rc_gpio.line[i].irq, &rc_gpio.line[i]);
+    del_timer_sync(&rc_gpio.lost_timer);
+    rc_gpio.probed = false;
+
+    return 0;
+}
+
+static const struct of_device_id rc_gpio_of_match[] =
+{
+    { .compatible = "rc-decoder,ppm" },
+    { },
+};
+MODULE_DEVICE_TABLE(of, rc_gpio_of_match);
+
+static struct platform_driver rc_gpio_driver =
+{
+    .probe = rc_gpio_probe,
+    .remove = rc_gpio_remove,
+    .driver =
+    {
+        .name = RC_GPIO_DRV_NAME,
+        .of_match_table = rc_gpio_of_match,
+    },
+};
+
+static int rc_gpio_init(rc_edge_t edge)
+{
+    int ret;
+
+    rc_gpio.edge = edge;
+    rc_gpio.probed = false;
+    rc_gpio.pdev = NULL;
+    rc_gpio.num_lines = 0;
+    rc_timebase_init(&rc_gpio.timebase, NSEC_PER_SEC);
+
+    if(gpio_chip != NULL)
+    {
+        rc_gpio_lookup.table[0] = GPIO_LOOKUP_IDX(gpio_chip, gpio_line, "ppm", 0, GPIO_ACTIVE_HIGH);
+        if(gpio_line2 >= 0)
+            rc_gpio_lookup.table[1] = GPIO_LOOKUP_IDX(gpio_chip, gpio_line2, "ppm", 1, GPIO_ACTIVE_HIGH);
+        gpiod_add_lookup_table(&rc_gpio_lookup);
+
+        rc_gpio.pdev = platform_device_register_simple(RC_GPIO_DRV_NAME, -1, NULL, 0);
+        if(IS_ERR(rc_gpio.pdev))
+        {
+            printk(KERN_ERR "Unable to register \"%s\" platform device\n", RC_GPIO_DRV_NAME);
+            gpiod_remove_lookup_table(&rc_gpio_lookup);
+            return PTR_ERR(rc_gpio.pdev);
+        }
+    }
+
+    ret = platform_driver_register(&rc_gpio_driver);
+    if(ret)
+    {
+        printk(KERN_ERR "Unable to register \"%s\" platform driver\n", RC_GPIO_DRV_NAME);
+        if(rc_gpio.pdev != NULL)
+        {
+            platform_device_unregister(rc_gpio.pdev);
+            gpiod_remove_lookup_table(&rc_gpio_lookup);
+        }
+        return ret;
+    }
+
+    /* Without a device the decoder just reports RC_REALLY_LOST until one
+       turns up, e.g. after a deferred probe */
+    if(!rc_gpio.probed)
+        printk(KERN_INFO "Waiting for \"%s\" device\n", RC_GPIO_DRV_NAME);
+
+    return 0;
+}
+
+static void rc_gpio_exit(void)
+{
+    platform_driver_unregister(&rc_gpio_driver);
+    if(rc_gpio.pdev != NULL)
+    {
+        platform_device_unregister(rc_gpio.pdev);
+        gpiod_remove_lookup_table(&rc_gpio_lookup);
+    }
+}
+
+static int rc_gpio_set_edge(rc_edge_t edge)
+{
+    int i, ret;
+
+    rc_gpio.edge = edge;
+    if(!rc_gpio.probed)
+        return 0;
+
+    for(i = 0; i < rc_gpio.num_lines; i++)
+    {
+        ret = irq_set_irq_type(rc_gpio.line[i].irq, rc_edge_irq_type(edge));
+        if(ret)
+            return ret;
+    }
+
+    return 0;
+}
+
+const rc_backend_t rc_gpio_backend =
+{
+    .name = "gpio",
+    .init = rc_gpio_init,
+    .exit = rc_gpio_exit,
+    .set_edge = rc_gpio_set_edge,
+};
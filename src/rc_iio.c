@@ -0,0 +1,219 @@
+/*
+   ENEL675 - Advanced Embedded Systems
+File: 		rc_iio.c
+Author: 	agent
+Date:  		19 October 2026
+
+Presents the decoder as an IIO device, for logging every frame
+through the standard IIO buffered capture path.
+
+Once the channels have been detected an IIO device "rc-ppm" is
+registered under /dev/rc, with one in_positionrelativeN channel per
+RC channel (16 bit pulse widths in microseconds) and a timestamp
+channel. Each frame is pushed into a kfifo buffer when it completes,
+stamped with the time of the start pulse that ended it in the clock
+the IIO device is set to use. The standard buffer/watermark attribute
+sets how many frames a reader waits for, e.g.
+
+    echo 25 > /sys/bus/iio/devices/iio:deviceX/buffer/watermark
+
+wakes a reader about twice a second. If a different number of
+channels is detected later, the device is registered again.
+
+Everything allocated for one registration is held in a devres group
+on the parent, so it can all be released at once when the number of
+channels changes.
+*/
+
+#include <linux/module.h>
+#include <linux/device.h>
+#include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
+#include <linux/iio/iio.h>
+#include <linux/iio/buffer.h>
+#include <linux/iio/kfifo_buf.h>
+#include "rc_frames.h"
+#include "rc_iio.h"
+
+#define RC_IIO_NAME				"rc-ppm"
+
+typedef struct
+{
+    struct device *parent;
+    void *group; /* devres group of the current registration */
+    struct iio_dev *indio_dev; /* NULL until channels are detected */
+    unsigned int num_channels;
+    frame_cursor_t cursor; /* Every frame is pushed */
+    struct work_struct work;
+} rc_iio_t;
+
+/* One scan, as laid out in the buffer */
+typedef struct
+{
+    u16 value[FRAME_MAX_VALUES];
+    s64 timestamp __aligned(8);
+} rc_iio_scan_t;
+
+/* local variables */
+static rc_iio_t rc_iio;
+
+static bool iio = true;
+module_param(iio, bool, 0444);
+MODULE_PARM_DESC(iio, "Present the decoder as an IIO device (default on)");
+
+static int rc_iio_read_raw(struct iio_dev *indio_dev, struct iio_chan_spec const *chan, int *val, int *val2, long mask)
+{
+    frame_t frame;
+
+    if(mask != IIO_CHAN_INFO_RAW)
+        return -EINVAL;
+    if(!rc_frame_latest(&frame) || chan->channel >= frame.num_values)
+        return -EAGAIN;
+
+    *val = frame.value[chan->channel];
+    return IIO_VAL_INT;
+}
+
+static const struct iio_info rc_iio_info =
+{
+    .read_raw = rc_iio_read_raw,
+};
+
+static void rc_iio_unregister(void)
+{
+    if(rc_iio.group == NULL)
+        return;
+
+    devres_release_group(rc_iio.parent, rc_iio.group);
+    rc_iio.group = NULL;
+    rc_iio.indio_dev = NULL;
+}
+
+/* Registers an IIO device with num_channels channels, replacing any
+   with a different number */
+static int rc_iio_register(unsigned int num_channels)
+{
+    struct device *parent = rc_iio.parent;
+    struct iio_dev *indio_dev;
+    struct iio_chan_spec *channels;
+    unsigned long *scan_masks;
+    int i, ret;
+
+    rc_iio_unregister();
+
+    rc_iio.group = devres_open_group(parent, NULL, GFP_KERNEL);
+    if(rc_iio.group == NULL)
+        return -ENOMEM;
+
+    ret = -ENOMEM;
+    indio_dev = devm_iio_device_alloc(parent, 0);
+    channels = devm_kcalloc(parent, num_channels + 1, sizeof(*channels), GFP_KERNEL);
+    scan_masks = devm_kcalloc(parent, 2, sizeof(*scan_masks), GFP_KERNEL);
+    if(indio_dev == NULL || channels == NULL || scan_masks == NULL)
+        goto fail;
+
+    for(i = 0; i < num_channels; i++)
+    {
+        channels[i].type = IIO_POSITIONRELATIVE;
+        channels[i].indexed = 1;
+        channels[i].channel = i;
+        channels[i].info_mask_separate = BIT(IIO_CHAN_INFO_RAW);
+        channels[i].scan_index = i;
+        channels[i].scan_type.sign = 'u';
+        channels[i].scan_type.realbits = 16;
+        channels[i].scan_type.storagebits = 16;
+        channels[i].scan_type.endianness = IIO_CPU;
+    }
+    channels[num_channels] = (struct iio_chan_spec)IIO_CHAN_SOFT_TIMESTAMP(num_channels);
+
+    /* Every scan holds all the channels, and the IIO core picks out
+       the ones that are enabled */
+    scan_masks[0] = GENMASK(num_channels - 1, 0);
+
+    indio_dev->name = RC_IIO_NAME;
+    indio_dev->info = &rc_iio_info;
+    indio_dev->modes = INDIO_DIRECT_MODE;
+    indio_dev->channels = channels;
+    indio_dev->num_channels = num_channels + 1;
+    indio_dev->available_scan_masks = scan_masks;
+
+    ret = devm_iio_kfifo_buffer_setup(parent, indio_dev, NULL);
+    if(ret)
+        goto fail;
+
+    ret = devm_iio_device_register(parent, indio_dev);
+    if(ret)
+        goto fail;
+
+    devres_close_group(parent, rc_iio.group);
+    rc_iio.indio_dev = indio_dev;
+    rc_iio.num_channels = num_channels;
+
+    return 0;
+
+fail:
+    printk(KERN_ERR "Unable to register \"%s\" IIO device\n", RC_IIO_NAME);
+    devres_release_group(parent, rc_iio.group);
+    rc_iio.group = NULL;
+    return ret;
+}
+
+static void rc_iio_work(struct work_struct *work)
+{
+    rc_iio_scan_t scan;
+    frame_t frame;
+    s64 offset_ns;
+    int i;
+
+    while(rc_frame_read(&rc_iio.cursor, &frame))
+    {
+        if(frame.num_values == 0)
+            continue;
+
+        if(rc_iio.indio_dev == NULL || rc_iio.num_channels != frame.num_values)
+        {
+            if(rc_iio_register(frame.num_values))
+                return;
+        }
+
+        if(!iio_buffer_enabled(rc_iio.indio_dev))
+            continue;
+
+        /* Frame times are CLOCK_MONOTONIC, so move them to the clock
+           chosen for the IIO device */
+        offset_ns = iio_get_time_ns(rc_iio.indio_dev) - ktime_get_ns();
+
+        memset(&scan, 0, sizeof(scan));
+        for(i = 0; i < frame.num_values; i++)
+            scan.value[i] = frame.value[i];
+        iio_push_to_buffers_with_timestamp(rc_iio.indio_dev, &scan, frame.time_ns + offset_ns);
+    }
+}
+
+/* Called from the ISR after each frame is committed */
+void rc_iio_frame(void)
+{
+    if(iio)
+        schedule_work(&rc_iio.work);
+}
+
+int rc_iio_init(struct device *parent)
+{
+    rc_iio.parent = parent;
+    rc_iio.group = NULL;
+    rc_iio.indio_dev = NULL;
+    rc_iio.num_channels = 0;
+    rc_frame_cursor_init(&rc_iio.cursor);
+    INIT_WORK(&rc_iio.work, rc_iio_work);
+
+    return 0;
+}
+
+/* Called once the backend has stopped, so no more work is scheduled,
+   and before parent goes away */
+void rc_iio_exit(void)
+{
+    cancel_work_sync(&rc_iio.work);
+    rc_iio_unregister();
+}
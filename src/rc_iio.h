@@ -0,0 +1,21 @@
+#ifndef RC_IIO_H
+#define RC_IIO_H
+
+/* The IIO device (rc_iio.c). rc.c tells it about each frame it
+   commits, and it pushes every frame into the IIO buffer from a work
+   item. parent is the device it is registered under. Only built when
+   RC_IIO is set. */
+
+#ifdef RC_IIO
+extern int rc_iio_init(struct device *parent);
+extern void rc_iio_exit(void);
+
+/* Called from the ISR after each frame is committed */
+extern void rc_iio_frame(void);
+#else
+static inline int rc_iio_init(struct device *parent) { return 0; }
+static inline void rc_iio_exit(void) { }
+static inline void rc_iio_frame(void) { }
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+/*
+   ENEL675 - Advanced Embedded Systems
+File: 		rc_input.c
+Author: 	agent
+Date:  		19 October 2026
+
+Presents the decoded channels as an evdev joystick, so standard tools
+and libraries can use the RC input without parsing /dev/rc.
+
+Once the channels have been detected an input device is registered
+with one absolute axis per channel, in order ABS_X, ABS_Y, ABS_Z,
+ABS_RX, ... Values are pulse widths in microseconds, and the range of
+each axis is the decoder's pulse limits when the device is registered,
+500 to 2500 with the standard profile. After each frame only the axes that changed
+are reported, followed by EV_SYN, stamped with the time of the start
+pulse that ended the frame. If a different number of channels is
+detected later, the device is registered again with that many axes.
+
+Reporting and registration run in a work item, so the ISR only
+schedules it.
+*/
+
+#include <linux/module.h>
+#include <linux/input.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
+#include <linux/mutex.h>
+#include "rc_frames.h"
+#include "rc_input.h"
+
+#define RC_INPUT_NAME				"RC PPM decoder"
+#define RC_INPUT_PHYS				"rc/input0"
+
+typedef struct
+{
+    struct input_dev *dev; /* NULL until channels are detected */
+    unsigned int num_axes;
+    unsigned int seq; /* Sequence number of the last frame reported */
+    unsigned int value[FRAME_MAX_VALUES]; /* Last values reported */
+    struct work_struct work;
+} rc_input_t;
+
+/* Axes in the order channels are assigned to them */
+static const unsigned int rc_input_axes[FRAME_MAX_VALUES] =
+{
+    ABS_X, ABS_Y, ABS_Z, ABS_RX, ABS_RY, ABS_RZ,
+    ABS_THROTTLE, ABS_RUDDER, ABS_WHEEL, ABS_GAS, ABS_BRAKE,
+    ABS_HAT0X, ABS_HAT0Y, ABS_HAT1X, ABS_HAT1Y,
+    ABS_HAT2X, ABS_HAT2Y, ABS_HAT3X, ABS_HAT3Y, ABS_MISC,
+};
+
+/* local variables */
+static rc_input_t rc_input;
+
+static bool evdev = true;
+module_param(evdev, bool, 0444);
+MODULE_PARM_DESC(evdev, "Present the channels as an evdev joystick (default on)");
+
+/* Registers an input device with num_axes axes, replacing any with a
+   different number */
+static int rc_input_register(unsigned int num_axes)
+{
+    struct input_dev *dev;
+    unsigned int min_us, max_us;
+    int i, ret;
+
+    if(rc_input.dev != NULL)
+    {
+        input_unregister_device(rc_input.dev);
+        rc_input.dev = NULL;
+    }
+
+    dev = input_allocate_device();
+    if(dev == NULL)
+        return -ENOMEM;
+
+    dev->name = RC_INPUT_NAME;
+    dev->phys = RC_INPUT_PHYS;
+    dev->id.bustype = BUS_HOST;
+    rc_frame_limits(&min_us, &max_us);
+    for(i = 0; i < num_axes; i++)
+        input_set_abs_params(dev, rc_input_axes[i], min_us, max_us, 0, 0);
+
+    ret = input_register_device(dev);
+    if(ret)
+    {
+        printk(KERN_ERR "Unable to register \"%s\" input device\n", RC_INPUT_NAME);
+        input_free_device(dev);
+        return ret;
+    }
+
+    rc_input.dev = dev;
+    rc_input.num_axes = num_axes;
+
+    /* Make sure every axis is reported once */
+    for(i = 0; i < num_axes; i++)
+        rc_input.value[i] = ~0;
+
+    return 0;
+}
+
+static void rc_input_work(struct work_struct *work)
+{
+    frame_t frame;
+    bool changed = false;
+    int i;
+
+    if(!rc_frame_latest(&frame) || frame.seq == rc_input.seq || frame.num_values == 0)
+        return;
+    rc_input.seq = frame.seq;
+
+    if(rc_input.dev == NULL || rc_input.num_axes != frame.num_values)
+    {
+        if(rc_input_register(frame.num_values))
+            return;
+    }
+
+    input_set_timestamp(rc_input.dev, ns_to_ktime(frame.time_ns));
+    for(i = 0; i < frame.num_values; i++)
+    {
+        if(frame.value[i] == rc_input.value[i])
+            continue;
+        input_report_abs(rc_input.dev, rc_input_axes[i], frame.value[i]);
+        rc_input.value[i] = frame.value[i];
+        changed = true;
+    }
+    if(changed)
+        input_sync(rc_input.dev);
+}
+
+/* Called from the ISR after each frame is committed */
+void rc_input_frame(void)
+{
+    if(evdev)
+        schedule_work(&rc_input.work);
+}
+
+int rc_input_init(void)
+{
+    rc_input.dev = NULL;
+    rc_input.num_axes = 0;
+    rc_input.seq = ~0;
+    INIT_WORK(&rc_input.work, rc_input_work);
+
+    return 0;
+}
+
+/* Called once the backend has stopped, so no more work is scheduled */
+void rc_input_exit(void)
+{
+    cancel_work_sync(&rc_input.work);
+    if(rc_input.dev != NULL)
+        input_unregister_device(rc_input.dev);
+    rc_input.dev = NULL;
+}
@@ -0,0 +1,13 @@
+#ifndef RC_INPUT_H
+#define RC_INPUT_H
+
+/* The evdev joystick (rc_input.c). rc.c tells it about each frame it
+   commits, and it reports the latest one from a work item. */
+
+extern int rc_input_init(void);
+extern void rc_input_exit(void);
+
+/* Called from the ISR after each frame is committed */
+extern void rc_input_frame(void);
+
+#endif
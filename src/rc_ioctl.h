@@ -0,0 +1,162 @@
+#ifndef RC_IOCTL_H
+#define RC_IOCTL_H
+
+/* ioctl interface of the decoder's devices, shared with userspace.
+   Times are CLOCK_MONOTONIC nanoseconds, as from clock_gettime(). */
+
+#include <linux/ioctl.h>
+#include <linux/types.h>
+
+#define RC_IOC_MAGIC			'r'
+
+/* Status at the start of each line read from /dev/rc */
+enum rc_status
+{
+    RC_STATUS_OK = 0,
+    RC_STATUS_LOST,
+    RC_STATUS_REALLY_LOST,
+};
+
+/* Status of the link, see RC_IOC_GET_STATUS */
+struct rc_status_info
+{
+    __u32 status; /* enum rc_status */
+    __u32 link_quality; /* 0 to 100% */
+    __u32 good_frames; /* Good frames in the last RC_LINK_WINDOW expected */
+    __u32 jitter_us; /* Average change in the interval between frames or in the start pulse, whichever is steadier */
+    __u32 num_channels; /* 0 until channels have been detected */
+    __u32 source; /* Input the frames are coming from */
+    __u32 frame_age_us; /* Since the start pulse ending the latest frame, or RC_AGE_NONE */
+    __u32 rejected_frames; /* Dropped by the decoder as bad, since it was loaded */
+    __u32 lapped_frames; /* Skipped by this open file for falling a ring behind */
+    __u32 reserved;
+};
+
+/* Age of a frame that does not exist. Real ages saturate one below */
+#define RC_AGE_NONE			0xffffffff
+
+#define RC_LINK_WINDOW			64
+
+/* /dev/rc: read the status of the link */
+#define RC_IOC_GET_STATUS		_IOR(RC_IOC_MAGIC, 3, struct rc_status_info)
+
+/* When an open file of /dev/rc becomes readable for poll(), see
+   RC_IOC_SET_WAKEUP. It is woken when a channel has moved by at least
+   threshold_us since its last read, when the status changes, or when
+   max_interval_ms has passed since its last read. A threshold of 0
+   wakes it on every frame, and an interval of 0 never times out. */
+struct rc_wakeup
+{
+    __u32 threshold_us;
+    __u32 max_interval_ms;
+    __u32 flags; /* RC_WAKEUP_* */
+    __u32 reserved;
+};
+
+/* read() blocks until woken, unless the file is O_NONBLOCK */
+#define RC_WAKEUP_BLOCK			0x1
+
+/* /dev/rc: set and get the wakeup rule of this open file */
+#define RC_IOC_SET_WAKEUP		_IOW(RC_IOC_MAGIC, 4, struct rc_wakeup)
+#define RC_IOC_GET_WAKEUP		_IOR(RC_IOC_MAGIC, 5, struct rc_wakeup)
+
+/* What read() returns on an open file of /dev/rc, see RC_IOC_SET_FORMAT */
+enum rc_format
+{
+    RC_FORMAT_TEXT = 0, /* A status line, as described in rc.c */
+    RC_FORMAT_BINARY, /* As many whole struct rc_frame_record as fit */
+};
+
+#define RC_RECORD_MAX_CHANNELS		20
+
+/* One frame as read in RC_FORMAT_BINARY. Records are read in order from
+   the next frame this file has not seen; a gap in seq means frames were
+   missed because the reader fell a whole ring behind. */
+struct rc_frame_record
+{
+    __u64 time_ns; /* Start pulse that ended the frame */
+    __u32 seq; /* Frame sequence number */
+    __u16 num_channels;
+    __u8 source; /* Input the frame was decoded from */
+    __u8 reserved8;
+    __u16 value_us[RC_RECORD_MAX_CHANNELS];
+    __u32 age_us; /* From time_ns until the record was read */
+    __u32 reserved;
+};
+
+/* /dev/rc: set the format read() returns for this open file (a __u32
+   enum rc_format). In RC_FORMAT_BINARY, read() waits for at least one
+   frame unless the file is O_NONBLOCK, and the wakeup threshold is
+   ignored so no frame is skipped. */
+#define RC_IOC_SET_FORMAT		_IOW(RC_IOC_MAGIC, 10, __u32)
+
+/* Estimate of the PPM frame clock, see /dev/rc_clock */
+struct rc_clock_state
+{
+    __s64 period_ns; /* Estimated frame period */
+    __s64 next_ns; /* Predicted time of the next start pulse */
+    __u32 locked; /* Non-zero once the estimate has settled */
+    __u32 slips; /* Times the estimate lost track and started again */
+};
+
+/* /dev/rc_clock: set how long after each predicted frame this open
+   file fires, in nanoseconds (0 to 1s) */
+#define RC_CLOCK_IOC_SET_OFFSET		_IOW(RC_IOC_MAGIC, 1, __s64)
+/* /dev/rc_clock: read the current estimate */
+#define RC_CLOCK_IOC_GET_STATE		_IOR(RC_IOC_MAGIC, 2, struct rc_clock_state)
+
+#define RC_OUT_MAX_CHANNELS		20
+
+/* A frame for the PPM output, written whole to /dev/rc_out. It is sent
+   from the start of the next frame and repeated until replaced. */
+struct rc_out_frame
+{
+    __u32 num_channels; /* 1 to RC_OUT_MAX_CHANNELS */
+    __u32 period_us; /* Must leave at least the output's sync gap */
+    __u32 value_us[RC_OUT_MAX_CHANNELS]; /* Each wider than the mark */
+};
+
+/* Statistics of the PPM output, see RC_OUT_IOC_GET_STATS */
+struct rc_out_stats
+{
+    __u64 frames; /* Frames started */
+    __u32 edges; /* Edges timed since the last reset */
+    __u32 jitter_mean_ns; /* Mean time between when each edge was due and when it was output */
+    __u32 jitter_max_ns; /* Worst case of the same */
+    __u32 num_channels; /* Of the frame being sent, 0 while idle */
+    __u32 period_us;
+    __u32 overruns; /* Edges so late the schedule had to restart */
+};
+
+/* /dev/rc_out: read the statistics, and reset the jitter figures */
+#define RC_OUT_IOC_GET_STATS		_IOR(RC_IOC_MAGIC, 6, struct rc_out_stats)
+#define RC_OUT_IOC_RESET_STATS		_IO(RC_IOC_MAGIC, 7)
+
+/* Forwarding of decoded frames straight to the PPM output, from the
+   ISR that decodes them, see RC_OUT_IOC_SET_PASSTHROUGH */
+enum rc_passthrough_mode
+{
+    RC_PASSTHROUGH_OFF = 0, /* The output sends what is written to it */
+    RC_PASSTHROUGH_ON, /* The output sends every decoded frame */
+    RC_PASSTHROUGH_SWITCH, /* As ON while the switch channel is above its threshold, else as OFF */
+};
+
+struct rc_passthrough
+{
+    __u32 mode; /* enum rc_passthrough_mode */
+    __u32 num_channels; /* Output channels, 0 for all the input's in order */
+    __u32 period_us; /* Output frame period, 0 for 22500 */
+    __u32 switch_channel; /* Input channel of the takeover switch */
+    __u32 switch_threshold_us; /* Width above which the switch takes over */
+    __u32 failsafe_ms; /* Time the last frame is held once no frame is forwarded, 0 for 500 */
+    __u8 map[RC_OUT_MAX_CHANNELS]; /* Input channel for each output channel */
+};
+
+/* /dev/rc_out: set and get the passthrough, in one call each. While
+   passthrough is driving the output, writes fail with EBUSY. If the
+   input is lost, or its frames can not be sent, the last frame sent is
+   held for failsafe_ms and the output is then handed back to writes. */
+#define RC_OUT_IOC_SET_PASSTHROUGH	_IOW(RC_IOC_MAGIC, 8, struct rc_passthrough)
+#define RC_OUT_IOC_GET_PASSTHROUGH	_IOR(RC_IOC_MAGIC, 9, struct rc_passthrough)
+
+#endif
@@ -0,0 +1,584 @@
+/*
+   ENEL675 - Advanced Embedded Systems
+File: 		rc_out.c
+Author: 	agent
+Date:  		19 October 2026
+
+PPM output generator, for driving servos and test rigs or feeding a
+flight controller in the loop. Frames written to /dev/rc_out, each a
+whole struct rc_out_frame (rc_ioctl.h), are encoded by ppm_enc.c and
+sent from the start of the next frame, repeating until replaced.
+
+The edges are clocked out by an hrtimer in hard interrupt context on
+an absolute schedule, each due time being the last one plus the
+segment length, so lateness of one edge never accumulates into the
+next. How late each edge was set is recorded; the mean and worst case
+are in /sys/class/misc/rc_out/ (frames, jitter_mean_ns, jitter_max_ns,
+overruns) and RC_OUT_IOC_GET_STATS. An edge more than a whole segment
+late counts as an overrun, and the schedule restarts from it.
+
+The pin is chosen with the output module parameter. "gpio" drives any
+GPIO that can be set without sleeping, named by out_gpio_chip and
+out_gpio_line, e.g. GPIO_145 on a gumstix is line 17 of the OMAP GPIO5
+bank. Without it no pin is driven.
+
+With loopback set to a source number, each falling edge is also fed
+into the decoder with its measured gap, so the encoder and decoder can
+be tested together on any machine, e.g. on a host with
+
+    insmod rc_decoder.ko backend=gpio loopback=1
+
+The loopback source must be one the backend is not feeding.
+
+Passthrough, set with RC_OUT_IOC_SET_PASSTHROUGH, forwards each frame
+the decoder publishes to the output from the same ISR, through a
+channel map, so a safety pilot can take over without waiting on
+userspace. It is on, off, or on while a switch channel is above a
+threshold. The setting is an immutable rc_out_passthrough_t published
+with RCU, as rc.c does for its configuration, so the ISR takes no lock
+to read it. A forwarded frame goes out from the start of the next
+output frame. If no frame has been forwarded for failsafe_ms, because
+the input is lost or its frames do not fit the output, the last one is
+held no longer and writes are accepted again. This is checked from the
+lost tick and at the start of each output frame, as a noisy input can
+keep edges arriving without ever making a frame.
+*/
+
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/miscdevice.h>
+#include <linux/device.h>
+#include <linux/sysfs.h>
+#include <linux/spinlock.h>
+#include <linux/hrtimer.h>
+#include <linux/rcupdate.h>
+#include <linux/mutex.h>
+#include <linux/slab.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/uaccess.h>
+#include <linux/gpio/consumer.h>
+#include <linux/gpio/machine.h>
+#include "rc_core.h"
+#include "rc_ioctl.h"
+#include "rc_out.h"
+#include "ppm_enc.h"
+
+#define RC_OUT_DEV_NAME				"rc_out"
+#define RC_OUT_MARK_US				300
+#define RC_OUT_PERIOD_US			22500 /* Passthrough period unless set */
+#define RC_OUT_FAILSAFE_MS			500 /* Passthrough hold unless set */
+#define RC_OUT_LOOPBACK_MAX_US		100000 /* Longer gaps are clamped, like the gpio backend's lost tick */
+
+typedef struct
+{
+    const char *name;
+    int (*init)(struct device *dev);
+    void (*exit)(void);
+    void (*set)(bool level); /* Called from the hrtimer, so must not sleep */
+} rc_out_pin_t;
+
+/* Never modified once published */
+typedef struct
+{
+    struct rc_passthrough cfg;
+    struct rcu_head rcu;
+} rc_out_passthrough_t;
+
+typedef struct
+{
+    const rc_out_pin_t *pin; /* NULL if no pin is driven */
+    rc_out_passthrough_t __rcu *passthrough; /* NULL while off */
+    struct mutex passthrough_mutex; /* Serialises publishers of passthrough */
+    bool passthrough_active; /* Writes are refused, the output is passthrough's */
+    unsigned int passthrough_frames; /* Frames forwarded */
+    ktime_t passthrough_time; /* When the last frame was forwarded */
+    s64 failsafe_ns; /* How long passthrough_active outlives it */
+    struct hrtimer timer;
+    spinlock_t lock; /* Protects enc, jitter and overruns */
+    ppm_enc_t enc;
+    ppm_enc_jitter_t jitter;
+    unsigned int overruns;
+    ktime_t last_fall; /* Time of the last falling edge, for loopback */
+} rc_out_t;
+
+/* local variables */
+static rc_out_t rc_out;
+
+static char *output = NULL;
+module_param(output, charp, 0444);
+MODULE_PARM_DESC(output, "Pin for the PPM output: \"gpio\" (default none)");
+
+static char *out_gpio_chip;
+module_param(out_gpio_chip, charp, 0444);
+MODULE_PARM_DESC(out_gpio_chip, "Label of the GPIO chip with the PPM output, for output=gpio");
+
+static unsigned int out_gpio_line;
+module_param(out_gpio_line, uint, 0444);
+MODULE_PARM_DESC(out_gpio_line, "Line of out_gpio_chip with the PPM output");
+
+static unsigned int out_sync_min_us = 6500;
+module_param(out_sync_min_us, uint, 0444);
+MODULE_PARM_DESC(out_sync_min_us, "Shortest sync gap output, which the receiver must see as a start pulse (default 6500)");
+
+static int loopback = -1;
+module_param(loopback, int, 0444);
+MODULE_PARM_DESC(loopback, "Also feed the output into the decoder as this source (default none)");
+
+static struct gpio_desc *rc_out_gpio;
+
+static struct gpiod_lookup_table rc_out_gpio_lookup =
+{
+    .dev_id = RC_OUT_DEV_NAME,
+    .table =
+    {
+        { }, /* Filled in from out_gpio_chip and out_gpio_line */
+        { },
+    },
+};
+
+static int rc_out_gpio_init(struct device *dev)
+{
+    if(out_gpio_chip == NULL)
+    {
+        printk(KERN_ERR "output=gpio needs out_gpio_chip\n");
+        return -EINVAL;
+    }
+    rc_out_gpio_lookup.table[0] = GPIO_LOOKUP(out_gpio_chip, out_gpio_line, "ppm-out", GPIO_ACTIVE_HIGH);
+    gpiod_add_lookup_table(&rc_out_gpio_lookup);
+
+    rc_out_gpio = gpiod_get(dev, "ppm-out", GPIOD_OUT_HIGH);
+    if(IS_ERR(rc_out_gpio))
+    {
+        printk(KERN_ERR "Unable to get \"ppm-out\" gpio\n");
+        gpiod_remove_lookup_table(&rc_out_gpio_lookup);
+        return PTR_ERR(rc_out_gpio);
+    }
+    if(gpiod_cansleep(rc_out_gpio))
+    {
+        printk(KERN_ERR "\"ppm-out\" gpio can not be set from a timer\n");
+        gpiod_put(rc_out_gpio);
+        gpiod_remove_lookup_table(&rc_out_gpio_lookup);
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+static void rc_out_gpio_exit(void)
+{
+    gpiod_put(rc_out_gpio);
+    gpiod_remove_lookup_table(&rc_out_gpio_lookup);
+}
+
+static void rc_out_gpio_set(bool level)
+{
+    gpiod_set_value(rc_out_gpio, level);
+}
+
+static const rc_out_pin_t rc_out_pins[] =
+{
+    { "gpio", rc_out_gpio_init, rc_out_gpio_exit, rc_out_gpio_set },
+};
+
+/* Hands the output back to writes once passthrough has forwarded
+   nothing for its failsafe time. Called with rc_out.lock held */
+static void rc_out_failsafe(ktime_t now)
+{
+    if(rc_out.passthrough_active && ktime_to_ns(ktime_sub(now, rc_out.passthrough_time)) >= rc_out.failsafe_ns)
+        WRITE_ONCE(rc_out.passthrough_active, false);
+}
+
+static enum hrtimer_restart rc_out_timer(struct hrtimer *timer)
+{
+    ktime_t due = hrtimer_get_expires(timer);
+    unsigned int segment_us, frames;
+    bool level, falling;
+    ktime_t now;
+
+    spin_lock(&rc_out.lock);
+    frames = rc_out.enc.frames;
+    segment_us = ppm_enc_next(&rc_out.enc, &level, &falling);
+    if(rc_out.pin != NULL)
+        rc_out.pin->set(level);
+    now = ktime_get();
+    if(rc_out.enc.frames != frames)
+        rc_out_failsafe(now);
+    ppm_enc_jitter_record(&rc_out.jitter, ktime_to_ns(ktime_sub(now, due)));
+
+    /* Far too late to keep to the schedule, so restart it from now */
+    if(ktime_us_delta(now, due) >= segment_us)
+    {
+        rc_out.overruns++;
+        due = now;
+    }
+    spin_unlock(&rc_out.lock);
+
+    if(falling && loopback >= 0)
+    {
+        rc_edge(loopback, min_t(s64, ktime_us_delta(now, rc_out.last_fall), RC_OUT_LOOPBACK_MAX_US), now);
+        rc_out.last_fall = now;
+    }
+
+    hrtimer_set_expires(timer, ktime_add_us(due, segment_us));
+
+    return HRTIMER_RESTART;
+}
+
+/* Whether passthrough takes frame, as its mode and switch say */
+static bool rc_out_passthrough_takes(const struct rc_passthrough *cfg, const unsigned int *value, unsigned int num_values)
+{
+    switch(cfg->mode)
+    {
+        case RC_PASSTHROUGH_ON:
+            return true;
+        case RC_PASSTHROUGH_SWITCH:
+            return cfg->switch_channel < num_values && value[cfg->switch_channel] > cfg->switch_threshold_us;
+        default:
+            return false;
+    }
+}
+
+/* Called from the ISR with each frame published */
+void rc_out_frame(const unsigned int *value, unsigned int num_values)
+{
+    const rc_out_passthrough_t *p;
+    unsigned int out[RC_OUT_MAX_CHANNELS];
+    unsigned int i, num_out, period_us;
+    unsigned long flags;
+    bool take;
+
+    rcu_read_lock();
+    p = rcu_dereference(rc_out.passthrough);
+    if(p == NULL)
+    {
+        rcu_read_unlock();
+        return;
+    }
+    take = rc_out_passthrough_takes(&p->cfg, value, num_values);
+    if(take)
+    {
+        num_out = p->cfg.num_channels ? p->cfg.num_channels : num_values;
+        period_us = p->cfg.period_us ? p->cfg.period_us : RC_OUT_PERIOD_US;
+        for(i = 0; i < num_out; i++)
+        {
+            unsigned int in = p->cfg.num_channels ? p->cfg.map[i] : i;
+
+            /* The input has fewer channels than the map needs */
+            if(in >= num_values)
+                break;
+            out[i] = value[in];
+        }
+        take = i == num_out;
+    }
+    rcu_read_unlock();
+
+    spin_lock_irqsave(&rc_out.lock, flags);
+    if(!take)
+    {
+        WRITE_ONCE(rc_out.passthrough_active, false);
+    }
+    else if(ppm_enc_set(&rc_out.enc, num_out, out, period_us) == 0)
+    {
+        rc_out.passthrough_frames++;
+        rc_out.passthrough_time = ktime_get();
+        WRITE_ONCE(rc_out.passthrough_active, true);
+    }
+    else
+    {
+        /* Can not be sent, so treated as if the input were lost */
+        rc_out_failsafe(ktime_get());
+    }
+    spin_unlock_irqrestore(&rc_out.lock, flags);
+}
+
+void rc_out_lost(void)
+{
+    unsigned long flags;
+
+    spin_lock_irqsave(&rc_out.lock, flags);
+    rc_out_failsafe(ktime_get());
+    spin_unlock_irqrestore(&rc_out.lock, flags);
+}
+
+static void rc_out_passthrough_free(struct rcu_head *head)
+{
+    kfree(container_of(head, rc_out_passthrough_t, rcu));
+}
+
+static int rc_out_set_passthrough(const struct rc_passthrough *cfg)
+{
+    rc_out_passthrough_t *new_p = NULL, *old_p;
+    int i;
+
+    if(cfg->mode > RC_PASSTHROUGH_SWITCH || cfg->num_channels > RC_OUT_MAX_CHANNELS
+        || cfg->switch_channel >= PPM_MAX_CHANNELS)
+        return -EINVAL;
+    for(i = 0; i < cfg->num_channels; i++)
+    {
+        if(cfg->map[i] >= PPM_MAX_CHANNELS)
+            return -EINVAL;
+    }
+
+    if(cfg->mode != RC_PASSTHROUGH_OFF)
+    {
+        new_p = kmalloc(sizeof(rc_out_passthrough_t), GFP_KERNEL);
+        if(new_p == NULL)
+            return -ENOMEM;
+        new_p->cfg = *cfg;
+    }
+
+    mutex_lock(&rc_out.passthrough_mutex);
+    old_p = rcu_dereference_protected(rc_out.passthrough, lockdep_is_held(&rc_out.passthrough_mutex));
+    rcu_assign_pointer(rc_out.passthrough, new_p);
+    spin_lock_irq(&rc_out.lock);
+    if(new_p == NULL)
+        WRITE_ONCE(rc_out.passthrough_active, false);
+    else
+        rc_out.failsafe_ns = (s64)(cfg->failsafe_ms ? cfg->failsafe_ms : RC_OUT_FAILSAFE_MS) * NSEC_PER_MSEC;
+    spin_unlock_irq(&rc_out.lock);
+    mutex_unlock(&rc_out.passthrough_mutex);
+
+    if(old_p != NULL)
+        call_rcu(&old_p->rcu, rc_out_passthrough_free);
+
+    return 0;
+}
+
+static void rc_out_get_passthrough(struct rc_passthrough *cfg)
+{
+    const rc_out_passthrough_t *p;
+
+    memset(cfg, 0, sizeof(*cfg));
+
+    rcu_read_lock();
+    p = rcu_dereference(rc_out.passthrough);
+    if(p != NULL)
+        *cfg = p->cfg;
+    rcu_read_unlock();
+}
+
+static ssize_t rc_out_write(struct file *file, const char __user *buf, size_t count, loff_t *ppos)
+{
+    struct rc_out_frame frame;
+    int ret = -EBUSY;
+
+    if(count != sizeof(frame))
+        return -EINVAL;
+    if(copy_from_user(&frame, buf, sizeof(frame)))
+        return -EFAULT;
+
+    spin_lock_irq(&rc_out.lock);
+    if(!rc_out.passthrough_active)
+        ret = ppm_enc_set(&rc_out.enc, frame.num_channels, frame.value_us, frame.period_us) ? -EINVAL : 0;
+    spin_unlock_irq(&rc_out.lock);
+
+    return ret ? ret : count;
+}
+
+static void rc_out_get_stats(struct rc_out_stats *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+
+    spin_lock_irq(&rc_out.lock);
+    stats->frames = rc_out.enc.frames;
+    stats->edges = rc_out.jitter.count;
+    stats->jitter_mean_ns = rc_out.jitter.count ? div_u64(rc_out.jitter.sum_ns, rc_out.jitter.count) : 0;
+    stats->jitter_max_ns = rc_out.jitter.max_ns;
+    stats->num_channels = rc_out.enc.num_channels;
+    stats->period_us = rc_out.enc.period_us;
+    stats->overruns = rc_out.overruns;
+    spin_unlock_irq(&rc_out.lock);
+}
+
+static long rc_out_ioctl(struct file *file, unsigned int cmd, unsigned long arg)
+{
+    struct rc_passthrough passthrough;
+    struct rc_out_stats stats;
+
+    switch(cmd)
+    {
+        case RC_OUT_IOC_GET_STATS:
+            rc_out_get_stats(&stats);
+            if(copy_to_user((void __user *)arg, &stats, sizeof(stats)))
+                return -EFAULT;
+            return 0;
+
+        case RC_OUT_IOC_RESET_STATS:
+            spin_lock_irq(&rc_out.lock);
+            ppm_enc_jitter_init(&rc_out.jitter);
+            rc_out.overruns = 0;
+            spin_unlock_irq(&rc_out.lock);
+            return 0;
+
+        case RC_OUT_IOC_SET_PASSTHROUGH:
+            if(copy_from_user(&passthrough, (void __user *)arg, sizeof(passthrough)))
+                return -EFAULT;
+            return rc_out_set_passthrough(&passthrough);
+
+        case RC_OUT_IOC_GET_PASSTHROUGH:
+            rc_out_get_passthrough(&passthrough);
+            if(copy_to_user((void __user *)arg, &passthrough, sizeof(passthrough)))
+                return -EFAULT;
+            return 0;
+
+        default:
+            return -ENOTTY;
+    }
+}
+
+static const struct file_operations rc_out_fops =
+{
+    .owner = THIS_MODULE,
+    .write = rc_out_write,
+    .unlocked_ioctl = rc_out_ioctl,
+    .compat_ioctl = compat_ptr_ioctl,
+    .llseek = noop_llseek,
+};
+
+static ssize_t frames_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct rc_out_stats stats;
+
+    rc_out_get_stats(&stats);
+    return sprintf(buf, "%llu\n", stats.frames);
+}
+static DEVICE_ATTR_RO(frames);
+
+static ssize_t jitter_mean_ns_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct rc_out_stats stats;
+
+    rc_out_get_stats(&stats);
+    return sprintf(buf, "%u\n", stats.jitter_mean_ns);
+}
+static DEVICE_ATTR_RO(jitter_mean_ns);
+
+static ssize_t jitter_max_ns_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct rc_out_stats stats;
+
+    rc_out_get_stats(&stats);
+    return sprintf(buf, "%u\n", stats.jitter_max_ns);
+}
+static DEVICE_ATTR_RO(jitter_max_ns);
+
+static ssize_t overruns_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct rc_out_stats stats;
+
+    rc_out_get_stats(&stats);
+    return sprintf(buf, "%u\n", stats.overruns);
+}
+static DEVICE_ATTR_RO(overruns);
+
+static const char *rc_out_passthrough_names[] = { "off", "on", "switch" };
+
+static ssize_t passthrough_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+    struct rc_passthrough cfg;
+
+    rc_out_get_passthrough(&cfg);
+    return sprintf(buf, "%s%s %u\n", rc_out_passthrough_names[cfg.mode],
+        READ_ONCE(rc_out.passthrough_active) ? " active" : "", READ_ONCE(rc_out.passthrough_frames));
+}
+static DEVICE_ATTR_RO(passthrough);
+
+static struct attribute *rc_out_attrs[] =
+{
+    &dev_attr_frames.attr,
+    &dev_attr_jitter_mean_ns.attr,
+    &dev_attr_jitter_max_ns.attr,
+    &dev_attr_overruns.attr,
+    &dev_attr_passthrough.attr,
+    NULL,
+};
+ATTRIBUTE_GROUPS(rc_out);
+
+static struct miscdevice rc_out_misc_dev =
+{
+    .minor = MISC_DYNAMIC_MINOR,
+    .name = RC_OUT_DEV_NAME,
+    .fops = &rc_out_fops,
+    .groups = rc_out_groups,
+};
+
+int rc_out_init(void)
+{
+    int i, ret;
+
+    BUILD_BUG_ON(RC_OUT_MAX_CHANNELS != PPM_MAX_CHANNELS);
+
+    if(loopback >= RC_MAX_SOURCES)
+    {
+        printk(KERN_ERR "No source %d to loop back into\n", loopback);
+        return -EINVAL;
+    }
+
+    spin_lock_init(&rc_out.lock);
+    ppm_enc_init(&rc_out.enc, RC_OUT_MARK_US, out_sync_min_us);
+    ppm_enc_jitter_init(&rc_out.jitter);
+    rc_out.overruns = 0;
+    rc_out.pin = NULL;
+    RCU_INIT_POINTER(rc_out.passthrough, NULL);
+    mutex_init(&rc_out.passthrough_mutex);
+    rc_out.passthrough_active = false;
+    rc_out.passthrough_frames = 0;
+    rc_out.failsafe_ns = (s64)RC_OUT_FAILSAFE_MS * NSEC_PER_MSEC;
+
+    ret = misc_register(&rc_out_misc_dev);
+    if(ret)
+    {
+        printk(KERN_ERR "Unable to register \"%s\" misc device\n", RC_OUT_DEV_NAME);
+        return ret;
+    }
+
+    /* Pick the pin, which is looked up against /dev/rc_out */
+    if(output != NULL)
+    {
+        for(i = 0; i < ARRAY_SIZE(rc_out_pins); i++)
+        {
+            if(strcmp(output, rc_out_pins[i].name) == 0)
+                break;
+        }
+        if(i == ARRAY_SIZE(rc_out_pins))
+        {
+            printk(KERN_ERR "Unknown output \"%s\"\n", output);
+            misc_deregister(&rc_out_misc_dev);
+            return -EINVAL;
+        }
+        ret = rc_out_pins[i].init(rc_out_misc_dev.this_device);
+        if(ret)
+        {
+            misc_deregister(&rc_out_misc_dev);
+            return ret;
+        }
+        rc_out.pin = &rc_out_pins[i];
+    }
+
+    /* Idle high until the first frame is written */
+    rc_out.last_fall = ktime_get();
+    hrtimer_init(&rc_out.timer, CLOCK_MONOTONIC, HRTIMER_MODE_ABS_HARD);
+    rc_out.timer.function = rc_out_timer;
+    hrtimer_start(&rc_out.timer, ktime_add_us(ktime_get(), PPM_ENC_IDLE_US), HRTIMER_MODE_ABS_HARD);
+
+    return 0;
+}
+
+void rc_out_exit(void)
+{
+    rc_out_passthrough_t *p;
+
+    hrtimer_cancel(&rc_out.timer);
+    if(rc_out.pin != NULL)
+        rc_out.pin->exit();
+    misc_deregister(&rc_out_misc_dev);
+
+    /* The backend may still be publishing frames, so wait for it to
+       finish with the passthrough before freeing it. Earlier ones are
+       freed by the time rc_exit() calls rcu_barrier() */
+    p = rcu_dereference_protected(rc_out.passthrough, 1);
+    RCU_INIT_POINTER(rc_out.passthrough, NULL);
+    synchronize_rcu();
+    kfree(p);
+}
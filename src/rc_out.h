@@ -0,0 +1,15 @@
+#ifndef RC_OUT_H
+#define RC_OUT_H
+
+/* The PPM output generator (rc_out.c), which provides /dev/rc_out. */
+
+extern int rc_out_init(void);
+extern void rc_out_exit(void);
+
+/* Called from the ISR with each frame published, for passthrough */
+extern void rc_out_frame(const unsigned int *value, unsigned int num_values);
+
+/* Called from the lost tick, so passthrough lets go of a lost input */
+extern void rc_out_lost(void);
+
+#endif
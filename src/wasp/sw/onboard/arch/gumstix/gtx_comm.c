@@ -1,12 +1,24 @@
+#include <sys/socket.h>
+
 #include "std.h"
 #include "comm.h"
 
-#include "lib/comm_network.h"
-
 #include "generated/settings.h"
 
+#include "gtx_comm.h"
+#include "gtx_comm_batch.h"
+
 SystemStatus_t comm_system_status = STATUS_UNINITIAIZED;
 
+/* Outgoing messages are batched, see gtx_comm_batch.h. Incoming ones
+   are read from the same socket, so the host sees one address and port
+   for both, as it did with comm_network. */
+static gtx_comm_batch_t comm_tx;
+
+static uint8_t comm_rx_buf[1500];
+static int comm_rx_len;
+static int comm_rx_pos;
+
 void comm_init ( CommChannel_t chan )
 {
     uint8_t i;
@@ -24,37 +36,60 @@ void comm_init ( CommChannel_t chan )
         comm_status[i].parse_error = 0;
     }
 
-    comm_network_init (
-        GUMSTIX_HOST_IP_ADDRESS,
-        GUMSTIX_HOST_PORT);
+    if (gtx_comm_batch_open (&comm_tx, GUMSTIX_HOST_IP_ADDRESS, GUMSTIX_HOST_PORT, GUMSTIX_HOST_PORT) < 0)
+        comm_system_status = STATUS_FAIL;
+}
 
+/* Sends everything queued this cycle, called once per main loop tick */
+void gtx_comm_flush ( void )
+{
+    gtx_comm_batch_flush (&comm_tx);
 }
 
 bool_t comm_ch_available ( CommChannel_t chan )
 {
-    return comm_network_ch_available();
+    int len;
+
+    if (comm_rx_pos == comm_rx_len && comm_tx.fd >= 0) {
+        len = recv (comm_tx.fd, comm_rx_buf, sizeof(comm_rx_buf), MSG_DONTWAIT);
+        comm_rx_len = len > 0 ? len : 0;
+        comm_rx_pos = 0;
+    }
+    return comm_rx_pos < comm_rx_len;
 }
 
 void comm_send_ch ( CommChannel_t chan, uint8_t c )
 {
-    comm_network_send_ch (c);
+    gtx_comm_batch_put (&comm_tx, c);
 }
 
 uint8_t comm_get_ch( CommChannel_t chan )
 {
-    return comm_network_get_ch ();
+    return comm_ch_available (chan) ? comm_rx_buf[comm_rx_pos++] : 0;
 }
 
 void comm_start_message_hw ( CommChannel_t chan )
 {
-    comm_network_start_message_hw ();
+    gtx_comm_batch_start (&comm_tx);
 }
 
 void comm_end_message_hw ( CommChannel_t chan )
 {
-    comm_network_end_message_hw ();
+    if (gtx_comm_batch_end (&comm_tx) < 0)
+        comm_overrun (chan);
 }
 
-bool_t  comm_check_free_space ( CommChannel_t chan, uint8_t len ) { return TRUE; }
-void    comm_overrun ( CommChannel_t chan ) {}
+bool_t comm_check_free_space ( CommChannel_t chan, uint8_t len )
+{
+    /* Make room by sending early rather than dropping the message */
+    if (gtx_comm_batch_free_space (&comm_tx) < len)
+        gtx_comm_batch_flush (&comm_tx);
+
+    return gtx_comm_batch_free_space (&comm_tx) >= len;
+}
+
+void comm_overrun ( CommChannel_t chan )
+{
+    comm_status[chan].buffer_overrun++;
+}
 
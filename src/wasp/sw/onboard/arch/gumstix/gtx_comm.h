@@ -0,0 +1,17 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_comm.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Gumstix additions to the comm API.
+
+ */
+
+#ifndef GTX_COMM_H
+#define GTX_COMM_H
+
+/* Sends the messages queued since the last call as one batch */
+void gtx_comm_flush(void);
+
+#endif
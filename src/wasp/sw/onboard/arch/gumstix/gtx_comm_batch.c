@@ -0,0 +1,174 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_comm_batch.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Batches outgoing comm messages into UDP datagrams, see
+    gtx_comm_batch.h.
+
+ */
+
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "gtx_comm_batch.h"
+
+int gtx_comm_batch_open(gtx_comm_batch_t *b, const char *host, int port, int local_port)
+{
+    struct sockaddr_in local;
+    int one = 1;
+
+    memset(b, 0, sizeof(*b));
+    b->msg_start = -1;
+
+    b->addr.sin_family = AF_INET;
+    b->addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &b->addr.sin_addr) != 1)
+    {
+        errno = EINVAL;
+        b->fd = -1;
+        return -1;
+    }
+
+    memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_port = htons(local_port);
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    b->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (b->fd < 0)
+        return -1;
+    setsockopt(b->fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(b->fd, (struct sockaddr *)&local, sizeof(local)) < 0)
+    {
+        close(b->fd);
+        b->fd = -1;
+        return -1;
+    }
+
+    return 0;
+}
+
+void gtx_comm_batch_close(gtx_comm_batch_t *b)
+{
+    if (b->fd >= 0)
+        close(b->fd);
+    b->fd = -1;
+}
+
+void gtx_comm_batch_start(gtx_comm_batch_t *b)
+{
+    /* An unfinished message is abandoned */
+    if (b->msg_start >= 0)
+        b->used = b->msg_start;
+
+    b->msg_start = b->used;
+    b->truncated = b->num_msgs == GTX_COMM_BATCH_MAX_MSGS;
+}
+
+void gtx_comm_batch_put(gtx_comm_batch_t *b, uint8_t c)
+{
+    if (b->msg_start < 0 || b->truncated)
+        return;
+    if (b->used == GTX_COMM_BATCH_BUF_LEN)
+    {
+        b->truncated = 1;
+        return;
+    }
+    b->buf[b->used++] = c;
+}
+
+int gtx_comm_batch_end(gtx_comm_batch_t *b)
+{
+    int start = b->msg_start;
+
+    if (start < 0)
+        return -1;
+    b->msg_start = -1;
+
+    if (b->truncated)
+    {
+        b->used = start;
+        b->msgs_dropped++;
+        return -1;
+    }
+    if (b->used == start)
+        return 0;
+
+    b->msg_offset[b->num_msgs] = start;
+    b->msg_len[b->num_msgs] = b->used - start;
+    b->num_msgs++;
+
+    return 0;
+}
+
+int gtx_comm_batch_free_space(const gtx_comm_batch_t *b)
+{
+    if (b->num_msgs == GTX_COMM_BATCH_MAX_MSGS)
+        return 0;
+    return GTX_COMM_BATCH_BUF_LEN - b->used;
+}
+
+int gtx_comm_batch_flush(gtx_comm_batch_t *b)
+{
+    struct mmsghdr msgs[GTX_COMM_BATCH_MAX_MSGS];
+    struct iovec iov[GTX_COMM_BATCH_MAX_MSGS];
+    int i, sent, keep_from, keep_len, ret;
+
+    if (b->num_msgs == 0 || b->fd < 0)
+        return 0;
+
+    memset(msgs, 0, b->num_msgs * sizeof(msgs[0]));
+    for (i = 0; i < b->num_msgs; i++)
+    {
+        iov[i].iov_base = b->buf + b->msg_offset[i];
+        iov[i].iov_len = b->msg_len[i];
+        msgs[i].msg_hdr.msg_name = &b->addr;
+        msgs[i].msg_hdr.msg_namelen = sizeof(b->addr);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    do
+    {
+        sent = sendmmsg(b->fd, msgs, b->num_msgs, MSG_DONTWAIT);
+        b->syscalls++;
+    } while (sent < 0 && errno == EINTR);
+
+    ret = sent;
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == ECONNREFUSED))
+        ret = sent = 0;
+    else if (sent < 0)
+    {
+        /* Drop the batch, as if it had been sent */
+        b->msgs_dropped += b->num_msgs;
+        sent = b->num_msgs;
+    }
+    else
+        b->msgs_sent += sent;
+
+    /* Keep what was not sent, and any message being built, at the front */
+    keep_from = sent < b->num_msgs ? b->msg_offset[sent] : (b->msg_start >= 0 ? b->msg_start : b->used);
+    keep_len = b->used - keep_from;
+    if (keep_from > 0 && keep_len > 0)
+        memmove(b->buf, b->buf + keep_from, keep_len);
+    for (i = sent; i < b->num_msgs; i++)
+    {
+        b->msg_offset[i - sent] = b->msg_offset[i] - keep_from;
+        b->msg_len[i - sent] = b->msg_len[i];
+    }
+    if (b->msg_start >= 0)
+        b->msg_start -= keep_from;
+    b->num_msgs -= sent;
+    b->used = keep_len;
+
+    return ret;
+}
@@ -0,0 +1,74 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_comm_batch.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Batches outgoing comm messages into UDP datagrams. Each message is
+    built in place in one buffer, between gtx_comm_batch_start() and
+    gtx_comm_batch_end(), and becomes one datagram. Whole batches go out
+    with a single sendmmsg() call from gtx_comm_batch_flush(), either
+    once per cycle or when the buffer fills.
+
+    The socket does not block. If the kernel will not take everything,
+    the rest of the batch stays buffered for the next flush, and
+    gtx_comm_batch_free_space() shrinks to match, so callers see real
+    backpressure instead of silent loss. Any other error, such as the
+    network being unreachable, drops the batch, as waiting would only
+    block the messages behind it.
+
+    The socket is bound to a given local port and is not connected, so
+    the same socket can also receive, and the peer sees one address.
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_COMM_BATCH_H
+#define GTX_COMM_BATCH_H
+
+#include <stdint.h>
+#include <netinet/in.h>
+
+#define GTX_COMM_BATCH_BUF_LEN      4096
+#define GTX_COMM_BATCH_MAX_MSGS     64
+
+typedef struct
+{
+    int fd;
+    struct sockaddr_in addr;    /* Where messages are sent */
+    uint8_t buf[GTX_COMM_BATCH_BUF_LEN];
+    int used;                   /* Bytes in buf, including a message being built */
+    int msg_start;              /* Offset of the message being built, or -1 */
+    int truncated;              /* Message being built ran out of space */
+    int num_msgs;               /* Complete messages waiting to be flushed */
+    uint16_t msg_offset[GTX_COMM_BATCH_MAX_MSGS];
+    uint16_t msg_len[GTX_COMM_BATCH_MAX_MSGS];
+
+    /* Statistics */
+    unsigned long msgs_sent;
+    unsigned long msgs_dropped;
+    unsigned long syscalls;
+} gtx_comm_batch_t;
+
+/* Opens a UDP socket bound to local_port (0 for any), sending to
+   host:port. Returns 0, or -1 with errno set. */
+int gtx_comm_batch_open(gtx_comm_batch_t *b, const char *host, int port, int local_port);
+void gtx_comm_batch_close(gtx_comm_batch_t *b);
+
+void gtx_comm_batch_start(gtx_comm_batch_t *b);
+void gtx_comm_batch_put(gtx_comm_batch_t *b, uint8_t c);
+
+/* Queues the message built since gtx_comm_batch_start(). Returns 0, or
+   -1 if it did not fit and was dropped. */
+int gtx_comm_batch_end(gtx_comm_batch_t *b);
+
+/* Bytes the next message may hold without being dropped, 0 if no more
+   messages can be queued until a flush. */
+int gtx_comm_batch_free_space(const gtx_comm_batch_t *b);
+
+/* Sends the queued messages. Returns the number sent, or -1 on an error
+   other than the socket being full, in which case the queued messages
+   are dropped and counted in msgs_dropped. */
+int gtx_comm_batch_flush(gtx_comm_batch_t *b);
+
+#endif
@@ -0,0 +1,140 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_latency.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Stick to actuator latency benchmark for the onboard loop.
+
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gtx_latency.h"
+
+#define FRAME_PERIOD_NS     22500000ULL
+#define NUM_CHANNELS        8
+#define MAX_SAMPLES         GTX_LATENCY_REPORT_FRAMES
+
+static const char *stage_names[GTX_LATENCY_NB_STAGES] = { "read", "normalized", "actuator" };
+
+static struct
+{
+    uint64_t start_ns;          /* Frame 0 completes at start_ns + period */
+    uint64_t seq[GTX_LATENCY_NB_STAGES];   /* Frame last stamped at each stage */
+    uint32_t latency_us[GTX_LATENCY_NB_STAGES][MAX_SAMPLES];
+    unsigned int count[GTX_LATENCY_NB_STAGES];
+    uint64_t last_read_seq;
+    unsigned long missed;       /* Frames completed but never read */
+} latency;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t frame_complete_ns(uint64_t seq)
+{
+    return latency.start_ns + (seq + 1) * FRAME_PERIOD_NS;
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+void gtx_latency_report(void)
+{
+    static uint32_t sorted[MAX_SAMPLES];
+    int stage;
+
+    if (latency.count[GTX_LATENCY_READ] == 0)
+        return;
+
+    fprintf(stderr, "latency from frame complete (us), %u frames, %lu never read\n",
+            latency.count[GTX_LATENCY_READ], latency.missed);
+    fprintf(stderr, "%-12s %8s %8s %8s %8s\n", "stage", "p50", "p90", "p99", "max");
+
+    for (stage = 0; stage < GTX_LATENCY_NB_STAGES; stage++)
+    {
+        unsigned int n = latency.count[stage];
+
+        if (n == 0)
+        {
+            fprintf(stderr, "%-12s %8s\n", stage_names[stage], "-");
+            continue;
+        }
+        memcpy(sorted, latency.latency_us[stage], n * sizeof(sorted[0]));
+        qsort(sorted, n, sizeof(sorted[0]), compare_u32);
+        fprintf(stderr, "%-12s %8u %8u %8u %8u\n", stage_names[stage],
+                sorted[n / 2], sorted[n * 90 / 100], sorted[n * 99 / 100], sorted[n - 1]);
+        latency.count[stage] = 0;
+    }
+    latency.missed = 0;
+}
+
+void gtx_latency_init(void)
+{
+    int stage;
+
+    memset(&latency, 0, sizeof(latency));
+    latency.start_ns = now_ns();
+    for (stage = 0; stage < GTX_LATENCY_NB_STAGES; stage++)
+        latency.seq[stage] = UINT64_MAX;
+    latency.last_read_seq = UINT64_MAX;
+}
+
+static void stamp(gtx_latency_stage_t stage, uint64_t seq)
+{
+    if (seq == UINT64_MAX || seq == latency.seq[stage])
+        return;
+    latency.seq[stage] = seq;
+
+    if (latency.count[stage] < MAX_SAMPLES)
+        latency.latency_us[stage][latency.count[stage]++] = (now_ns() - frame_complete_ns(seq)) / 1000;
+
+    /* The last stage completes the set */
+    if (stage == GTX_LATENCY_NB_STAGES - 1 && latency.count[stage] == MAX_SAMPLES)
+        gtx_latency_report();
+}
+
+void gtx_latency_stamp(gtx_latency_stage_t stage)
+{
+    /* Follow the frame that the previous stage last saw */
+    stamp(stage, stage > 0 ? latency.seq[stage - 1] : latency.last_read_seq);
+}
+
+int gtx_latency_source_read(gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels)
+{
+    uint64_t now = now_ns();
+    uint64_t seq;
+    int channel, num_channels;
+
+    if (now < frame_complete_ns(0))
+    {
+        *status = GTX_RC_PARSE_REALLY_LOST;
+        return 0;
+    }
+    seq = (now - latency.start_ns) / FRAME_PERIOD_NS - 1;
+
+    if (latency.last_read_seq != UINT64_MAX && seq > latency.last_read_seq + 1)
+        latency.missed += seq - latency.last_read_seq - 1;
+    latency.last_read_seq = seq;
+
+    /* Every channel changes every frame, as on a moving stick */
+    num_channels = NUM_CHANNELS < max_channels ? NUM_CHANNELS : max_channels;
+    for (channel = 0; channel < num_channels; channel++)
+        pulses[channel] = 1000 + (seq * 37 + channel * 111) % 1000;
+
+    *status = GTX_RC_PARSE_OK;
+    stamp(GTX_LATENCY_READ, seq);
+
+    return num_channels;
+}
@@ -0,0 +1,57 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_latency.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Stick to actuator latency benchmark for the onboard loop.
+
+    Built with GTX_LATENCY_BENCH defined, gtx_rc.c reads synthetic
+    frames from a stand-in RC source instead of /dev/rc, and the stub
+    actuators in gtx_unsimulated.c stamp when they are commanded. Each
+    frame "completes" at a known CLOCK_MONOTONIC time on a 22.5ms grid,
+    and the time from then until each later stage is recorded:
+
+        read        rc_periodic_task() got the frame
+        normalized  rc_values[] hold it
+        actuator    the first actuators_set() after that
+
+    Percentiles of each stage, and the number of frames the loop never
+    read, are printed to stderr every GTX_LATENCY_REPORT_FRAMES frames,
+    and by gtx_latency_report() for the frames since.
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_LATENCY_H
+#define GTX_LATENCY_H
+
+#include <stdint.h>
+
+#include "gtx_rc_parse.h"
+
+#define GTX_LATENCY_REPORT_FRAMES       2000
+
+typedef enum
+{
+    GTX_LATENCY_READ = 0,
+    GTX_LATENCY_NORMALIZED,
+    GTX_LATENCY_ACTUATOR,
+    GTX_LATENCY_NB_STAGES,
+} gtx_latency_stage_t;
+
+void gtx_latency_init(void);
+
+/* The stand-in RC source. Returns the latest completed synthetic frame
+   as gtx_rc_parse_line() would, and stamps GTX_LATENCY_READ. */
+int gtx_latency_source_read(gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels);
+
+/* Records that the frame last seen by the previous stage has reached
+   stage. Only the first stamp of each frame at each stage counts. */
+void gtx_latency_stamp(gtx_latency_stage_t stage);
+
+/* Prints the frames stamped since the last report, if any, e.g. at the
+   end of a run shorter than GTX_LATENCY_REPORT_FRAMES frames. */
+void gtx_latency_report(void);
+
+#endif
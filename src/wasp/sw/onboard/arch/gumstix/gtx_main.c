@@ -6,6 +6,8 @@
 
 #include "lib/time_helpers.h"
 
+#include "gtx_comm.h"
+
 uint16_t cpu_time_sec;
 uint8_t  cpu_usage;
 
@@ -34,7 +36,11 @@ bool_t sys_time_periodic( void )
 
 
     if (should_run == FALSE)
+    {
+        /* Tasks for this tick are done, send their messages in one go */
+        gtx_comm_flush();
         time_helpers_sleep(sleep_time);
+    }
         
     return should_run;
 }
@@ -69,8 +69,6 @@ file rc.h
 }}} */
 
 #include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -83,14 +81,71 @@ file rc.h
 
 #include "led.h"
 
+#include "gtx_rc_parse.h"
+#ifdef GTX_RC_TELEMETRY
+#include "comm.h"
+#include "gtx_rc_telemetry.h"
+#endif
+#if defined(GTX_LATENCY_BENCH)
+#include "gtx_latency.h"
+#elif defined(GTX_RC_GPIOD)
+#include "gtx_rc_gpiod.h"
+#endif
+
 #define FP_DEV_NAME     "/dev/rc"
-#define FP_LINE_WIDTH   128
+#define FP_LINE_WIDTH   160
+
+/* Line the userspace decoder reads, GPIO_144 on the gumstix */
+#ifndef GTX_RC_GPIOD_CHIP
+#define GTX_RC_GPIOD_CHIP       "/dev/gpiochip4"
+#endif
+#ifndef GTX_RC_GPIOD_LINE
+#define GTX_RC_GPIOD_LINE       16
+#endif
 
 SystemStatus_t rc_system_status = STATUS_UNINITIAIZED;
 
 int fp_dev; 
 int ThisNormalizePpm(int val);
 
+#if defined(GTX_LATENCY_BENCH)
+
+/* Stand-in source of synthetic frames, see gtx_latency.h */
+void rc_init ( void )
+{
+    gtx_latency_init ();
+    led_log ("Latency benchmark, reading synthetic frames\n");
+    rc_system_status = STATUS_INITIALIZED;
+}
+
+static int rc_read_pulses ( gtx_rc_parse_status_t *status )
+{
+    return gtx_latency_source_read (status, ppm_pulses, RADIO_CTL_NB);
+}
+
+#elif defined(GTX_RC_GPIOD)
+
+void rc_init ( void )
+{
+    if(gtx_rc_gpiod_open(GTX_RC_GPIOD_CHIP, GTX_RC_GPIOD_LINE) == 0)
+    {
+        led_log ("Opened %s line %d\n", GTX_RC_GPIOD_CHIP, GTX_RC_GPIOD_LINE);
+        rc_system_status = STATUS_INITIALIZED;
+    }
+    else
+    {
+        led_log ("Failed to open %s line %d\n", GTX_RC_GPIOD_CHIP, GTX_RC_GPIOD_LINE);
+        rc_system_status = STATUS_FAIL;
+    }
+}
+
+static int rc_read_pulses ( gtx_rc_parse_status_t *status )
+{
+    return gtx_rc_gpiod_poll (status, ppm_pulses, RADIO_CTL_NB);
+}
+
+#else
+
 void rc_init ( void )
 {
     fp_dev = open(FP_DEV_NAME, O_RDONLY);
@@ -106,30 +161,86 @@ void rc_init ( void )
     }
 }
 
-void rc_periodic_task ( void )
-{ 
-    int channel = 0, len;
+static int rc_read_pulses ( gtx_rc_parse_status_t *status )
+{
+    int len;
     char line [FP_LINE_WIDTH];
-    
+
     lseek(fp_dev, 0, SEEK_SET);
     len = read(fp_dev, line, FP_LINE_WIDTH);
-    if (len > 0)
+    if (len <= 0)
+        return -1;
+
+    return gtx_rc_parse_line (line, len, status, ppm_pulses, RADIO_CTL_NB);
+}
+
+#endif
+
+#ifdef GTX_RC_TELEMETRY
+
+/* Zeroed, as gtx_rc_telemetry_init() leaves it */
+static gtx_rc_telemetry_t rc_telemetry;
+
+/* Mirrors the frame to the ground station as a single message. A
+   message dropped for lack of space shows up there as a lost packet,
+   and the encoder is put back as it was, so a dropped keyframe is never
+   taken as sent. A read with no new frame sends nothing, as an empty
+   keyframe would force the next frame to be a keyframe too. */
+static void rc_send_telemetry ( gtx_rc_parse_status_t status, int num_channels )
+{
+    uint8_t buf[GTX_RC_TELEMETRY_MAX_LEN];
+    gtx_rc_telemetry_t saved;
+    int i, len;
+
+    if (num_channels == 0 && status == GTX_RC_PARSE_OK)
+        return;
+
+    saved = rc_telemetry;
+    len = gtx_rc_telemetry_encode (&rc_telemetry, status, ppm_pulses, num_channels, buf);
+    if (!comm_check_free_space (COMM_TELEMETRY, len))
     {
-        char *token;
-        token = strtok (line, ",");
-        if (strcmp (token, "RC_OK"))
+        saved.seq = rc_telemetry.seq;
+        rc_telemetry = saved;
+        comm_overrun (COMM_TELEMETRY);
+        return;
+    }
+
+    comm_start_message_hw (COMM_TELEMETRY);
+    for (i = 0; i < len; i++)
+        comm_send_ch (COMM_TELEMETRY, buf[i]);
+    comm_end_message_hw (COMM_TELEMETRY);
+}
+
+#endif
+
+void rc_periodic_task ( void )
+{ 
+    int channel, num_channels;
+    gtx_rc_parse_status_t status;
+    
+    num_channels = rc_read_pulses (&status);
+    if (num_channels >= 0)
+    {
+        if (status == GTX_RC_PARSE_OK)
             rc_status = RC_OK;
-        else if (strcmp (token, "RC_LOST"))
+        else if (status == GTX_RC_PARSE_LOST)
             rc_status = RC_LOST;
         else
             rc_status = RC_REALLY_LOST;
 
-        while ((token = strtok (NULL, ",")) != NULL)
-        {
-            ppm_pulses[channel] = atoi(token);
+        for (channel = 0; channel < num_channels; channel++)
             rc_values[channel] = ThisNormalizePpm(ppm_pulses[channel]);
-            channel++;
-        }
+#ifdef GTX_LATENCY_BENCH
+        gtx_latency_stamp (GTX_LATENCY_NORMALIZED);
+#endif
+#ifdef GTX_RC_TELEMETRY
+        rc_send_telemetry (status, num_channels);
+#endif
+    }
+    else
+    {
+        /* Never keep reporting the last sticks as valid */
+        rc_status = RC_REALLY_LOST;
     }
 }
 
@@ -139,19 +250,20 @@ bool_t rc_event_task ( void )
     return (rc_status == RC_OK);
 }
 
-#define MIN_PULSE_LIMIT    50
-#define MAX_PULSE_LIMIT    250
-#define NEUTRAL_PULSE      150
+/* Pulse widths from /dev/rc are in microseconds */
+#define MIN_PULSE_LIMIT    500
+#define MAX_PULSE_LIMIT    2500
+#define NEUTRAL_PULSE      1500
 int ThisNormalizePpm(int val)
 {
     int ret = val - NEUTRAL_PULSE;
     if(ret > 0)
     {
-        ret *= (9600 / MAX_PULSE_LIMIT);
+        ret = ret * 9600 / MAX_PULSE_LIMIT;
     }
     else
     {
-        ret *= (9600 / MIN_PULSE_LIMIT);
+        ret = ret * 9600 / MIN_PULSE_LIMIT;
     }
     return ret;
 }
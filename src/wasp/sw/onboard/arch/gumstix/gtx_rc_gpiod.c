@@ -0,0 +1,199 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_gpiod.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Userspace PPM decoder on libgpiod edge events.
+
+    Follows rc_edge() and rc_status() in the module: the gaps between
+    edges go through ppm_decode(), and the lost ticks the module counts
+    at 10Hz are worked out from the time since the last edge.
+
+ */
+
+#include <string.h>
+#include <time.h>
+#include <gpiod.h>
+
+#include "ppm.h"
+#include "gtx_rc_gpiod.h"
+
+#define GPIOD_CONSUMER          "rc"
+#define EVENT_BATCH             64  /* Events read per syscall */
+#define EVENT_BUFFER            256 /* Events the kernel holds for us */
+#define LOST_TICK_NS            100000000LL /* i.e. 10Hz, as in the module */
+#define REALLY_LOST_TICKS       20 /* i.e. 20 x 100ms = 2s */
+
+static const ppm_timing_t standard_timing = { 6000, 15000, 500, 2500 };
+
+static struct
+{
+    struct gpiod_chip *chip;
+    struct gpiod_line_request *request;
+    struct gpiod_edge_event_buffer *events;
+    ppm_decoder_t decoder;
+    uint64_t last_edge_ns;
+    int have_edge;
+    int num_values;     /* Of the latest good frame */
+    uint16_t value[PPM_MAX_CHANNELS];
+    gtx_rc_gpiod_stats_t stats;
+} gpiod_rc;
+
+static uint64_t clock_ns(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+int gtx_rc_gpiod_open(const char *chip, unsigned int line)
+{
+    struct gpiod_line_settings *settings = NULL;
+    struct gpiod_line_config *line_cfg = NULL;
+    struct gpiod_request_config *req_cfg = NULL;
+
+    memset(&gpiod_rc, 0, sizeof(gpiod_rc));
+    ppm_decoder_init(&gpiod_rc.decoder);
+
+    gpiod_rc.chip = gpiod_chip_open(chip);
+    if (gpiod_rc.chip == NULL)
+        return -1;
+
+    settings = gpiod_line_settings_new();
+    line_cfg = gpiod_line_config_new();
+    req_cfg = gpiod_request_config_new();
+    gpiod_rc.events = gpiod_edge_event_buffer_new(EVENT_BATCH);
+    if (settings == NULL || line_cfg == NULL || req_cfg == NULL || gpiod_rc.events == NULL)
+        goto fail;
+
+    /* The module measures between falling edges, and uses the same
+       clock as the frame timestamps */
+    gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+    gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_FALLING);
+    gpiod_line_settings_set_event_clock(settings, GPIOD_LINE_CLOCK_MONOTONIC);
+    if (gpiod_line_config_add_line_settings(line_cfg, &line, 1, settings) < 0)
+        goto fail;
+
+    gpiod_request_config_set_consumer(req_cfg, GPIOD_CONSUMER);
+    gpiod_request_config_set_event_buffer_size(req_cfg, EVENT_BUFFER);
+
+    gpiod_rc.request = gpiod_chip_request_lines(gpiod_rc.chip, req_cfg, line_cfg);
+    if (gpiod_rc.request == NULL)
+        goto fail;
+
+    gpiod_request_config_free(req_cfg);
+    gpiod_line_config_free(line_cfg);
+    gpiod_line_settings_free(settings);
+    return 0;
+
+fail:
+    gpiod_request_config_free(req_cfg);
+    gpiod_line_config_free(line_cfg);
+    gpiod_line_settings_free(settings);
+    gtx_rc_gpiod_close();
+    return -1;
+}
+
+void gtx_rc_gpiod_close(void)
+{
+    if (gpiod_rc.request != NULL)
+        gpiod_line_request_release(gpiod_rc.request);
+    if (gpiod_rc.events != NULL)
+        gpiod_edge_event_buffer_free(gpiod_rc.events);
+    if (gpiod_rc.chip != NULL)
+        gpiod_chip_close(gpiod_rc.chip);
+    gpiod_rc.request = NULL;
+    gpiod_rc.events = NULL;
+    gpiod_rc.chip = NULL;
+}
+
+static void decode_edge(uint64_t t_ns)
+{
+    ppm_decoder_t *dec = &gpiod_rc.decoder;
+    uint64_t dt_ns = t_ns - gpiod_rc.last_edge_ns;
+    unsigned int dt_us, channel;
+
+    /* Anything longer than a lost tick is just a very long gap, as in
+       the gpio backend of the module */
+    if (!gpiod_rc.have_edge || dt_ns > LOST_TICK_NS)
+        dt_ns = LOST_TICK_NS;
+    dt_us = dt_ns / 1000;
+
+    gpiod_rc.last_edge_ns = t_ns;
+    gpiod_rc.have_edge = 1;
+
+    switch (ppm_decode(dec, &standard_timing, dt_us))
+    {
+        case PPM_EVENT_FRAME:
+            for (channel = 0; channel < dec->num_channels; channel++)
+                gpiod_rc.value[channel] = dec->value[channel];
+            gpiod_rc.num_values = dec->num_channels;
+            break;
+        case PPM_EVENT_RESET:
+            gpiod_rc.num_values = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+int gtx_rc_gpiod_poll(gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels)
+{
+    uint64_t cpu_start = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    uint64_t lost_ticks;
+    int channel, num_channels;
+
+    for (;;)
+    {
+        int ret, i;
+
+        ret = gpiod_line_request_wait_edge_events(gpiod_rc.request, 0);
+        if (ret < 0)
+            return -1;
+        if (ret == 0)
+            break;
+
+        ret = gpiod_line_request_read_edge_events(gpiod_rc.request, gpiod_rc.events, EVENT_BATCH);
+        if (ret < 0)
+            return -1;
+
+        for (i = 0; i < ret; i++)
+        {
+            struct gpiod_edge_event *event = gpiod_edge_event_buffer_get_event(gpiod_rc.events, i);
+            decode_edge(gpiod_edge_event_get_timestamp_ns(event));
+        }
+
+        gpiod_rc.stats.edges += ret;
+        gpiod_rc.stats.batches++;
+        if (ret < EVENT_BATCH)
+            break;
+    }
+
+    gpiod_rc.stats.cpu_ns += clock_ns(CLOCK_THREAD_CPUTIME_ID) - cpu_start;
+
+    /* Same rules as rc_status() in the module */
+    lost_ticks = gpiod_rc.have_edge ? (clock_ns(CLOCK_MONOTONIC) - gpiod_rc.last_edge_ns) / LOST_TICK_NS : REALLY_LOST_TICKS;
+    num_channels = gpiod_rc.decoder.num_channels;
+    if (lost_ticks == 0 && num_channels && gpiod_rc.decoder.mode != PPM_DETECT_CHANNELS)
+        *status = GTX_RC_PARSE_OK;
+    else if (lost_ticks < REALLY_LOST_TICKS && num_channels)
+        *status = GTX_RC_PARSE_LOST;
+    else
+        *status = GTX_RC_PARSE_REALLY_LOST;
+
+    if (*status != GTX_RC_PARSE_OK)
+        return 0;
+
+    num_channels = gpiod_rc.num_values < max_channels ? gpiod_rc.num_values : max_channels;
+    for (channel = 0; channel < num_channels; channel++)
+        pulses[channel] = gpiod_rc.value[channel];
+
+    return num_channels;
+}
+
+void gtx_rc_gpiod_get_stats(gtx_rc_gpiod_stats_t *stats)
+{
+    *stats = gpiod_rc.stats;
+}
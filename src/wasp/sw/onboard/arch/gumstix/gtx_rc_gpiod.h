@@ -0,0 +1,48 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_gpiod.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Userspace PPM decoder, for boards where the rc_decoder module can
+    not be loaded. Edges come from the GPIO character device through
+    libgpiod (v2), timestamped by the kernel, and are decoded by the
+    same state machine as the module (src/ppm.c).
+
+    Build gtx_rc.c with GTX_RC_GPIOD defined to use it instead of
+    /dev/rc, and link this, ppm.c and -lgpiod.
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_RC_GPIOD_H
+#define GTX_RC_GPIOD_H
+
+#include <stdint.h>
+
+#include "gtx_rc_parse.h"
+
+/* Cost of decoding, to compare with the kernel module */
+typedef struct
+{
+    uint64_t edges;     /* Edges decoded */
+    uint64_t batches;   /* Reads of the event buffer, i.e. syscalls */
+    uint64_t cpu_ns;    /* Thread CPU time spent reading and decoding */
+} gtx_rc_gpiod_stats_t;
+
+/* Requests falling edge events on line of chip, e.g. "/dev/gpiochip0".
+   Returns 0, or -1 if the line could not be requested. */
+int gtx_rc_gpiod_open(const char *chip, unsigned int line);
+
+void gtx_rc_gpiod_close(void);
+
+/* Decodes every edge that has arrived, without blocking, reading as
+   many events per syscall as the buffer holds. Then reports the status
+   as /dev/rc would and the pulse widths of the latest good frame, up
+   to max_channels of them. Returns the number of channels, or -1 on
+   error. */
+int gtx_rc_gpiod_poll(gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels);
+
+void gtx_rc_gpiod_get_stats(gtx_rc_gpiod_stats_t *stats);
+
+#endif
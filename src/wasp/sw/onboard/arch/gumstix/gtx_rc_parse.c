@@ -0,0 +1,73 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_parse.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Parser for the text lines read from /dev/rc.
+
+ */
+
+#include "gtx_rc_parse.h"
+
+#define STATUS_PREFIX_LEN       3 /* "RC_" */
+
+int gtx_rc_parse_line(const char *line, int len, gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels)
+{
+    const char *p = line;
+    const char *end = line + len;
+    int channel = 0;
+
+    if (len <= STATUS_PREFIX_LEN || line[0] != 'R' || line[1] != 'C' || line[2] != '_')
+        return -1;
+
+    /* The first letter after "RC_" is enough to tell the statuses apart */
+    switch (line[STATUS_PREFIX_LEN])
+    {
+        case 'O':
+            *status = GTX_RC_PARSE_OK;
+            break;
+        case 'L':
+            *status = GTX_RC_PARSE_LOST;
+            break;
+        case 'R':
+            *status = GTX_RC_PARSE_REALLY_LOST;
+            break;
+        default:
+            return -1;
+    }
+
+    /* Skip the rest of the status */
+    p += STATUS_PREFIX_LEN;
+    while (p < end && *p != ',' && *p != '\n')
+        p++;
+
+    /* Each value is a ',' followed by decimal digits */
+    while (p < end && *p == ',')
+    {
+        unsigned int val = 0;
+        unsigned int digit;
+        const char *start = ++p;
+
+        /* Stop accumulating once past UINT16_MAX, so a long run of
+           digits saturates rather than wrapping to a small value */
+        while (p < end && (digit = (unsigned int)(*p - '0')) < 10)
+        {
+            if (val <= UINT16_MAX)
+                val = val * 10 + digit;
+            p++;
+        }
+
+        if (p == start)
+            return -1;
+
+        /* Channels beyond those wanted are checked but not kept */
+        if (channel < max_channels)
+            pulses[channel++] = val > UINT16_MAX ? UINT16_MAX : val;
+    }
+
+    if (p < end && *p != '\n' && *p != '\0')
+        return -1;
+
+    return channel;
+}
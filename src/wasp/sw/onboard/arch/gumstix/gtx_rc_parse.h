@@ -0,0 +1,33 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_parse.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Parser for the text lines read from /dev/rc, e.g.
+    "RC_OK,1020,1990,2950,3920\n"
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_RC_PARSE_H
+#define GTX_RC_PARSE_H
+
+#include <stdint.h>
+
+typedef enum
+{
+    GTX_RC_PARSE_OK = 0,
+    GTX_RC_PARSE_LOST,
+    GTX_RC_PARSE_REALLY_LOST,
+} gtx_rc_parse_status_t;
+
+/* Parses one line in a single pass, without libc calls or allocation.
+   Status is matched on its prefix and pulse widths are stored in pulses.
+   Only the first max_channels are stored and any more are ignored, so a
+   transmitter with extra channels still works. The line does not need
+   to be null terminated. Returns the number of channels stored, or -1
+   if the line is malformed. */
+int gtx_rc_parse_line(const char *line, int len, gtx_rc_parse_status_t *status, uint16_t *pulses, int max_channels);
+
+#endif
@@ -0,0 +1,223 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_predict.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Extrapolation of RC channel values between PPM frames.
+
+    The query is the part that runs at the control rate, so with GCC it
+    works on four channels at a time using vector extensions, which
+    become SSE on a host or NEON on the gumstix. The update runs once a
+    frame and is plain C. The scalar query is kept for other compilers
+    and to check the vector one against, see tools/rc_predict_check.
+
+ */
+
+/* Both query paths must round alike, so neither may fuse
+   value + rate * dt into a single FMA where the other does not. */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#include <string.h>
+
+#include "gtx_rc_predict.h"
+
+#define DEFAULT_ALPHA           0.7f
+#define DEFAULT_BETA            0.25f
+#define DEFAULT_SLEW_MAX        20000.0f /* i.e. full throw in 50ms */
+#define DEFAULT_HORIZON         0.03f    /* About one and a half frames */
+#define DEFAULT_MAX_GAP         0.1f     /* About five frames */
+#define DEFAULT_LO              500.0f
+#define DEFAULT_HI              2500.0f
+
+void gtx_rc_predict_init(gtx_rc_predict_t *p, gtx_rc_predict_mode_t mode, int num_channels)
+{
+    int channel;
+
+    if (num_channels > GTX_RC_PREDICT_MAX_CHANNELS)
+        num_channels = GTX_RC_PREDICT_MAX_CHANNELS;
+
+    p->mode = mode;
+    p->num_channels = num_channels;
+    p->alpha = DEFAULT_ALPHA;
+    p->beta = DEFAULT_BETA;
+    p->slew_max = DEFAULT_SLEW_MAX;
+    p->horizon = DEFAULT_HORIZON;
+    p->max_gap = DEFAULT_MAX_GAP;
+    p->lo = DEFAULT_LO;
+    p->hi = DEFAULT_HI;
+    p->started = 0;
+    p->last_t = 0.0;
+
+    /* Until the first frame, every channel reads as centred */
+    for (channel = 0; channel < GTX_RC_PREDICT_MAX_CHANNELS; channel++)
+    {
+        p->value[channel] = (DEFAULT_LO + DEFAULT_HI) / 2;
+        p->rate[channel] = 0.0f;
+        p->target[channel] = p->value[channel];
+    }
+}
+
+void gtx_rc_predict_update(gtx_rc_predict_t *p, double t, const uint16_t *pulses)
+{
+    float dt = (float)(t - p->last_t);
+    int restart = !p->started || dt <= 0.0f || dt > p->max_gap;
+    int channel;
+
+    switch (p->mode)
+    {
+        case GTX_RC_PREDICT_LINEAR:
+            for (channel = 0; channel < p->num_channels; channel++)
+            {
+                float meas = pulses[channel];
+                p->rate[channel] = restart ? 0.0f : (meas - p->value[channel]) / dt;
+                p->value[channel] = meas;
+            }
+            break;
+
+        case GTX_RC_PREDICT_ALPHA_BETA:
+            for (channel = 0; channel < p->num_channels; channel++)
+            {
+                float meas = pulses[channel];
+                float predicted, residual;
+
+                if (restart)
+                {
+                    p->value[channel] = meas;
+                    p->rate[channel] = 0.0f;
+                    continue;
+                }
+                predicted = p->value[channel] + p->rate[channel] * dt;
+                residual = meas - predicted;
+                p->value[channel] = predicted + p->alpha * residual;
+                p->rate[channel] += p->beta * residual / dt;
+            }
+            break;
+
+        case GTX_RC_PREDICT_SLEW:
+            /* Ramp on from wherever the output has got to */
+            if (!restart)
+                gtx_rc_predict_query(p, t, p->value);
+            for (channel = 0; channel < p->num_channels; channel++)
+            {
+                p->target[channel] = pulses[channel];
+                if (restart)
+                    p->value[channel] = p->target[channel];
+            }
+            break;
+    }
+
+    p->last_t = t;
+    p->started = 1;
+}
+
+static inline float clampf(float x, float lo, float hi)
+{
+    return x < lo ? lo : (x > hi ? hi : x);
+}
+
+void gtx_rc_predict_query_scalar(const gtx_rc_predict_t *p, double t, float *out)
+{
+    float dt = (float)(t - p->last_t);
+    int channel;
+
+    if (dt < 0.0f)
+        dt = 0.0f;
+
+    if (p->mode == GTX_RC_PREDICT_SLEW)
+    {
+        float step = p->slew_max * dt;
+        for (channel = 0; channel < p->num_channels; channel++)
+        {
+            float delta = clampf(p->target[channel] - p->value[channel], -step, step);
+            out[channel] = clampf(p->value[channel] + delta, p->lo, p->hi);
+        }
+    }
+    else
+    {
+        if (dt > p->horizon)
+            dt = p->horizon;
+        for (channel = 0; channel < p->num_channels; channel++)
+            out[channel] = clampf(p->value[channel] + p->rate[channel] * dt, p->lo, p->hi);
+    }
+}
+
+#if defined(__GNUC__)
+
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int32_t v4si __attribute__((vector_size(16)));
+
+static inline v4sf v4sf_splat(float x)
+{
+    v4sf v = { x, x, x, x };
+    return v;
+}
+
+static inline v4sf v4sf_select(v4si mask, v4sf a, v4sf b)
+{
+    return (v4sf)((mask & (v4si)a) | (~mask & (v4si)b));
+}
+
+static inline v4sf v4sf_clamp(v4sf x, v4sf lo, v4sf hi)
+{
+    x = v4sf_select(x < lo, lo, x);
+    return v4sf_select(x > hi, hi, x);
+}
+
+/* Stores only the first n lanes, as out is only num_channels long */
+static inline void v4sf_store(float *out, v4sf v, int n)
+{
+    memcpy(out, &v, (n < 4 ? n : 4) * sizeof(float));
+}
+
+void gtx_rc_predict_query(const gtx_rc_predict_t *p, double t, float *out)
+{
+    float dt = (float)(t - p->last_t);
+    v4sf lo = v4sf_splat(p->lo);
+    v4sf hi = v4sf_splat(p->hi);
+    int channel;
+
+    if (dt < 0.0f)
+        dt = 0.0f;
+
+    if (p->mode == GTX_RC_PREDICT_SLEW)
+    {
+        v4sf step = v4sf_splat(p->slew_max * dt);
+        v4sf neg_step = -step;
+
+        for (channel = 0; channel < p->num_channels; channel += 4)
+        {
+            v4sf value = *(const v4sf *)&p->value[channel];
+            v4sf delta = *(const v4sf *)&p->target[channel] - value;
+            v4sf_store(&out[channel], v4sf_clamp(value + v4sf_clamp(delta, neg_step, step), lo, hi), p->num_channels - channel);
+        }
+    }
+    else
+    {
+        v4sf vdt;
+
+        if (dt > p->horizon)
+            dt = p->horizon;
+        vdt = v4sf_splat(dt);
+
+        for (channel = 0; channel < p->num_channels; channel += 4)
+        {
+            v4sf value = *(const v4sf *)&p->value[channel];
+            v4sf rate = *(const v4sf *)&p->rate[channel];
+            v4sf_store(&out[channel], v4sf_clamp(value + rate * vdt, lo, hi), p->num_channels - channel);
+        }
+    }
+}
+
+#else
+
+void gtx_rc_predict_query(const gtx_rc_predict_t *p, double t, float *out)
+{
+    gtx_rc_predict_query_scalar(p, t, out);
+}
+
+#endif
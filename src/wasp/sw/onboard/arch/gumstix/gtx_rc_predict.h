@@ -0,0 +1,85 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_predict.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Extrapolates RC channel values between PPM frames, so a control
+    loop running faster than the frame rate sees smooth inputs instead
+    of a step every frame. Feed it each new frame with
+    gtx_rc_predict_update() and query it as often as needed with
+    gtx_rc_predict_query(). Neither allocates, and both are O(channels).
+
+    Modes:
+    GTX_RC_PREDICT_LINEAR      Continues the slope of the last two frames.
+    GTX_RC_PREDICT_ALPHA_BETA  Continues a filtered position and rate,
+                               which rides out jitter in the pulses.
+    GTX_RC_PREDICT_SLEW        Ramps from the previous output towards the
+                               latest frame at no more than slew_max.
+                               Never overshoots, but adds lag.
+
+    Extrapolation stops after horizon seconds, so a lost signal holds
+    its last prediction instead of running away, and the output is
+    clamped to [lo, hi].
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_RC_PREDICT_H
+#define GTX_RC_PREDICT_H
+
+#include <stdint.h>
+
+/* A multiple of 4, so the vector path needs no remainder loop */
+#define GTX_RC_PREDICT_MAX_CHANNELS     20
+
+#if defined(__GNUC__)
+#define GTX_RC_PREDICT_ALIGN    __attribute__((aligned(16)))
+#else
+#define GTX_RC_PREDICT_ALIGN
+#endif
+
+typedef enum
+{
+    GTX_RC_PREDICT_LINEAR = 0,
+    GTX_RC_PREDICT_ALPHA_BETA,
+    GTX_RC_PREDICT_SLEW,
+} gtx_rc_predict_mode_t;
+
+typedef struct
+{
+    gtx_rc_predict_mode_t mode;
+    int num_channels;
+
+    /* Tuning, set to defaults by gtx_rc_predict_init() */
+    float alpha;        /* Alpha-beta position gain, 0 to 1 */
+    float beta;         /* Alpha-beta rate gain */
+    float slew_max;     /* Slew mode, fastest change in units per second */
+    float horizon;      /* Longest extrapolation after a frame, seconds */
+    float max_gap;      /* Longer between frames restarts the estimate, seconds */
+    float lo, hi;       /* Limits of the output */
+
+    /* State at the time of the last frame */
+    int started;
+    double last_t;
+    float value[GTX_RC_PREDICT_MAX_CHANNELS] GTX_RC_PREDICT_ALIGN;  /* Position */
+    float rate[GTX_RC_PREDICT_MAX_CHANNELS] GTX_RC_PREDICT_ALIGN;   /* Units per second */
+    float target[GTX_RC_PREDICT_MAX_CHANNELS] GTX_RC_PREDICT_ALIGN; /* Slew mode only */
+} gtx_rc_predict_t;
+
+/* Sets defaults for a signal in microseconds at about 45-50Hz */
+void gtx_rc_predict_init(gtx_rc_predict_t *p, gtx_rc_predict_mode_t mode, int num_channels);
+
+/* Adds a frame of pulse widths that arrived at time t, in seconds */
+void gtx_rc_predict_update(gtx_rc_predict_t *p, double t, const uint16_t *pulses);
+
+/* Writes the predicted value of every channel at time t, in seconds,
+   to out. t should not be before the last frame. */
+void gtx_rc_predict_query(const gtx_rc_predict_t *p, double t, float *out);
+
+/* The same query one channel at a time in plain C. It is what
+   gtx_rc_predict_query() uses without GCC vector extensions, and gives
+   bit for bit the same results as the vector path. */
+void gtx_rc_predict_query_scalar(const gtx_rc_predict_t *p, double t, float *out);
+
+#endif
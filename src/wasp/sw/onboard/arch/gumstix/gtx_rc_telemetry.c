@@ -0,0 +1,266 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_telemetry.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Compact RC telemetry, see gtx_rc_telemetry.h.
+
+ */
+
+#include <string.h>
+
+#include "gtx_rc_telemetry.h"
+
+#define HEADER_LEN      3
+#define CHECKSUM_LEN    2
+#define WIDTH_BITS      4
+#define CRC_BITS        16
+#define FLAG_KEYFRAME   0x80
+#define STATUS_SHIFT    5
+#define CHANNELS_MASK   0x1f
+
+typedef struct
+{
+    uint8_t *buf;
+    int len;            /* Bytes in buf, the last one may be partly filled */
+    int bits;           /* Bits used in the last byte */
+} bit_writer_t;
+
+typedef struct
+{
+    const uint8_t *buf;
+    int len;
+    int pos;            /* In bits */
+} bit_reader_t;
+
+static void put_bits(bit_writer_t *w, uint32_t value, int bits)
+{
+    while (bits > 0)
+    {
+        int n;
+
+        if (w->bits == 0 || w->bits == 8)
+        {
+            w->buf[w->len++] = 0;
+            w->bits = 0;
+        }
+        n = 8 - w->bits < bits ? 8 - w->bits : bits;
+        bits -= n;
+        w->buf[w->len - 1] |= ((value >> bits) & ((1 << n) - 1)) << (8 - w->bits - n);
+        w->bits += n;
+    }
+}
+
+/* Returns -1 if the packet is too short */
+static int32_t get_bits(bit_reader_t *r, int bits)
+{
+    uint32_t value = 0;
+
+    if (r->pos + bits > r->len * 8)
+        return -1;
+    while (bits-- > 0)
+    {
+        value = (value << 1) | ((r->buf[r->pos >> 3] >> (7 - (r->pos & 7))) & 1);
+        r->pos++;
+    }
+    return value;
+}
+
+static uint32_t zigzag(int32_t delta)
+{
+    return delta >= 0 ? (uint32_t)delta << 1 : ((uint32_t)-delta << 1) - 1;
+}
+
+static int32_t unzigzag(uint32_t code)
+{
+    return code & 1 ? -(int32_t)((code + 1) >> 1) : (int32_t)(code >> 1);
+}
+
+static int width_of(uint32_t value)
+{
+    int width = 0;
+
+    while (value)
+    {
+        width++;
+        value >>= 1;
+    }
+    return width;
+}
+
+static uint16_t clamp_pulse(uint16_t pulse)
+{
+    if (pulse < GTX_RC_TELEMETRY_PULSE_MIN)
+        return GTX_RC_TELEMETRY_PULSE_MIN;
+    if (pulse > GTX_RC_TELEMETRY_PULSE_MAX)
+        return GTX_RC_TELEMETRY_PULSE_MAX;
+    return pulse;
+}
+
+static void checksum(const uint8_t *buf, int len, uint8_t *ck_a, uint8_t *ck_b)
+{
+    int i;
+
+    *ck_a = *ck_b = 0;
+    for (i = 0; i < len; i++)
+    {
+        *ck_a += buf[i];
+        *ck_b += *ck_a;
+    }
+}
+
+/* CRC-16-CCITT of the values. Keyframes that differ in one channel
+   never share one, and others only by chance, 1 in 65536 */
+static uint16_t key_crc(const uint16_t *values, int num_channels)
+{
+    uint16_t crc = 0xffff;
+    int channel, bit;
+
+    for (channel = 0; channel < num_channels; channel++)
+    {
+        crc ^= values[channel];
+        for (bit = 0; bit < 16; bit++)
+            crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+void gtx_rc_telemetry_init(gtx_rc_telemetry_t *t)
+{
+    memset(t, 0, sizeof(*t));
+}
+
+int gtx_rc_telemetry_encode(gtx_rc_telemetry_t *enc, gtx_rc_parse_status_t status,
+                            const uint16_t *pulses, int num_channels, uint8_t *buf)
+{
+    uint16_t values[GTX_RC_TELEMETRY_MAX_CHANNELS];
+    uint32_t max_code = 0;
+    int channel, changed = 0, width, keyframe;
+    bit_writer_t w = { buf, HEADER_LEN, 0 };
+
+    if (num_channels > GTX_RC_TELEMETRY_MAX_CHANNELS)
+        num_channels = GTX_RC_TELEMETRY_MAX_CHANNELS;
+    if (num_channels < 0)
+        num_channels = 0;
+
+    for (channel = 0; channel < num_channels; channel++)
+    {
+        values[channel] = clamp_pulse(pulses[channel]);
+        if (channel < enc->num_channels && values[channel] != enc->key[channel])
+        {
+            uint32_t code = zigzag(values[channel] - enc->key[channel]);
+            if (code > max_code)
+                max_code = code;
+            changed++;
+        }
+    }
+    width = width_of(max_code);
+
+    keyframe = num_channels != enc->num_channels || num_channels == 0
+            || enc->since_keyframe >= GTX_RC_TELEMETRY_KEYFRAME_INTERVAL - 1
+            || CRC_BITS + WIDTH_BITS + num_channels + changed * width >= num_channels * GTX_RC_TELEMETRY_PULSE_BITS;
+
+    if (keyframe)
+    {
+        for (channel = 0; channel < num_channels; channel++)
+            put_bits(&w, values[channel] - GTX_RC_TELEMETRY_PULSE_MIN, GTX_RC_TELEMETRY_PULSE_BITS);
+        memcpy(enc->key, values, num_channels * sizeof(values[0]));
+        enc->num_channels = num_channels;
+        enc->key_crc = key_crc(values, num_channels);
+        enc->since_keyframe = 0;
+    }
+    else
+    {
+        put_bits(&w, enc->key_crc, CRC_BITS);
+        put_bits(&w, width, WIDTH_BITS);
+        for (channel = 0; channel < num_channels; channel++)
+            put_bits(&w, values[channel] != enc->key[channel], 1);
+        for (channel = 0; channel < num_channels; channel++)
+            if (values[channel] != enc->key[channel])
+                put_bits(&w, zigzag(values[channel] - enc->key[channel]), width);
+        enc->since_keyframe++;
+    }
+
+    buf[0] = GTX_RC_TELEMETRY_STX;
+    buf[1] = enc->seq++;
+    buf[2] = (keyframe ? FLAG_KEYFRAME : 0) | (status << STATUS_SHIFT) | num_channels;
+    checksum(buf, w.len, &buf[w.len], &buf[w.len + 1]);
+
+    return w.len + CHECKSUM_LEN;
+}
+
+int gtx_rc_telemetry_decode(gtx_rc_telemetry_t *dec, const uint8_t *buf, int len,
+                            gtx_rc_parse_status_t *status, uint16_t *pulses)
+{
+    uint16_t values[GTX_RC_TELEMETRY_MAX_CHANNELS];
+    uint8_t ck_a, ck_b;
+    int channel, num_channels, width;
+    int32_t code;
+    bit_reader_t r;
+
+    if (len < HEADER_LEN + CHECKSUM_LEN || buf[0] != GTX_RC_TELEMETRY_STX)
+        return -1;
+    checksum(buf, len - CHECKSUM_LEN, &ck_a, &ck_b);
+    if (ck_a != buf[len - 2] || ck_b != buf[len - 1])
+        return -1;
+
+    num_channels = buf[2] & CHANNELS_MASK;
+    if (num_channels > GTX_RC_TELEMETRY_MAX_CHANNELS || ((buf[2] >> STATUS_SHIFT) & 3) > GTX_RC_PARSE_REALLY_LOST)
+        return -1;
+
+    r.buf = buf + HEADER_LEN;
+    r.len = len - HEADER_LEN - CHECKSUM_LEN;
+    r.pos = 0;
+
+    if (buf[2] & FLAG_KEYFRAME)
+    {
+        for (channel = 0; channel < num_channels; channel++)
+        {
+            code = get_bits(&r, GTX_RC_TELEMETRY_PULSE_BITS);
+            if (code < 0)
+                return -1;
+            values[channel] = GTX_RC_TELEMETRY_PULSE_MIN + code;
+        }
+        memcpy(dec->key, values, num_channels * sizeof(values[0]));
+        dec->num_channels = num_channels;
+        dec->key_crc = key_crc(values, num_channels);
+    }
+    else
+    {
+        uint32_t mask = 0;
+
+        /* A delta only applies to the keyframe it names, which must be
+           the one held */
+        code = get_bits(&r, CRC_BITS);
+        if (code < 0 || dec->num_channels == 0 || num_channels != dec->num_channels
+            || code != dec->key_crc)
+            return -1;
+        width = get_bits(&r, WIDTH_BITS);
+        if (width < 0 || width > GTX_RC_TELEMETRY_PULSE_BITS + 1)
+            return -1;
+        for (channel = 0; channel < num_channels; channel++)
+        {
+            code = get_bits(&r, 1);
+            if (code < 0)
+                return -1;
+            mask |= (uint32_t)code << channel;
+        }
+        for (channel = 0; channel < num_channels; channel++)
+        {
+            values[channel] = dec->key[channel];
+            if (mask & (1u << channel))
+            {
+                code = get_bits(&r, width);
+                if (code < 0)
+                    return -1;
+                values[channel] += unzigzag(code);
+            }
+        }
+    }
+
+    memcpy(pulses, values, num_channels * sizeof(values[0]));
+    *status = (buf[2] >> STATUS_SHIFT) & 3;
+
+    return num_channels;
+}
@@ -0,0 +1,82 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		gtx_rc_telemetry.h
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Compact RC telemetry, so every frame can be mirrored to the ground
+    station. Each packet is either a keyframe, holding every channel at
+    its real 11 bit width, or a delta against the last keyframe. A delta
+    carries a CRC of that keyframe's values, a bit mask of the channels
+    that differ from it and their zigzag coded differences, all at the
+    smallest width that fits the largest of them, so a still stick costs
+    one bit.
+
+        byte 0      GTX_RC_TELEMETRY_STX
+        byte 1      sequence number, incremented every packet
+        byte 2      bit 7 keyframe, bits 6-5 status, bits 4-0 channels
+        payload     keyframe: channels x 11 bits, pulse - 800us
+                    delta:    16 bit CRC of the keyframe, 4 bit width,
+                              channels bit mask, then a width bit
+                              difference per changed channel
+        ck_a, ck_b  Fletcher checksum of the bytes before, as in wasp
+
+    Bits are packed MSB first and the payload is padded to a byte.
+
+    A keyframe is sent every GTX_RC_TELEMETRY_KEYFRAME_INTERVAL packets,
+    whenever the channel count changes and whenever it is no bigger than
+    the delta. As every delta only depends on its keyframe, losing a
+    delta costs nothing but that frame, and only losing a keyframe
+    drops the deltas after it, until the next keyframe. The CRC, rather
+    than the sequence number, names the keyframe, so after an outage of
+    any length a delta is never applied to an older keyframe with other
+    values. Pulses are clamped to 800-2847us.
+
+    Kept free of the wasp headers so it can also be built on a host.
+ */
+
+#ifndef GTX_RC_TELEMETRY_H
+#define GTX_RC_TELEMETRY_H
+
+#include <stdint.h>
+
+#include "gtx_rc_parse.h"
+
+#define GTX_RC_TELEMETRY_STX                    0x52
+#define GTX_RC_TELEMETRY_MAX_CHANNELS           20
+#define GTX_RC_TELEMETRY_KEYFRAME_INTERVAL      32
+
+#define GTX_RC_TELEMETRY_PULSE_MIN              800
+#define GTX_RC_TELEMETRY_PULSE_BITS             11
+#define GTX_RC_TELEMETRY_PULSE_MAX              (GTX_RC_TELEMETRY_PULSE_MIN + (1 << GTX_RC_TELEMETRY_PULSE_BITS) - 1)
+
+/* Header, a full keyframe and the checksum */
+#define GTX_RC_TELEMETRY_MAX_LEN \
+    (3 + (GTX_RC_TELEMETRY_MAX_CHANNELS * GTX_RC_TELEMETRY_PULSE_BITS + 7) / 8 + 2)
+
+/* State of one end of the link, encoder or decoder */
+typedef struct
+{
+    uint16_t key[GTX_RC_TELEMETRY_MAX_CHANNELS]; /* Values of the last keyframe */
+    int num_channels;   /* Of the last keyframe, 0 until one is sent or received */
+    uint16_t key_crc;   /* CRC of the last keyframe's values */
+    uint8_t seq;        /* Encoder only, of the next packet */
+    int since_keyframe; /* Encoder only, deltas sent since the keyframe */
+} gtx_rc_telemetry_t;
+
+void gtx_rc_telemetry_init(gtx_rc_telemetry_t *t);
+
+/* Packs one frame into buf, which must hold GTX_RC_TELEMETRY_MAX_LEN
+   bytes. Channels beyond GTX_RC_TELEMETRY_MAX_CHANNELS are not sent.
+   Returns the packet length. */
+int gtx_rc_telemetry_encode(gtx_rc_telemetry_t *enc, gtx_rc_parse_status_t status,
+                            const uint16_t *pulses, int num_channels, uint8_t *buf);
+
+/* Unpacks one packet into pulses, which must hold
+   GTX_RC_TELEMETRY_MAX_CHANNELS values. Returns the number of channels,
+   or -1 if the packet is malformed or is a delta whose keyframe was
+   lost. */
+int gtx_rc_telemetry_decode(gtx_rc_telemetry_t *dec, const uint8_t *buf, int len,
+                            gtx_rc_parse_status_t *status, uint16_t *pulses);
+
+#endif
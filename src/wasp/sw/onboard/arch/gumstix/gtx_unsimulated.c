@@ -36,7 +36,12 @@ uint8_t imu_event_task ( void ) { return 0; }
 
 #include "actuators.h"
 void actuators_init( uint8_t bank ) {}
+#ifdef GTX_LATENCY_BENCH
+#include "gtx_latency.h"
+void actuators_set( ActuatorID_t id, uint8_t value ) { gtx_latency_stamp(GTX_LATENCY_ACTUATOR); }
+#else
 void actuators_set( ActuatorID_t id, uint8_t value ) {}
+#endif
 void actuators_commit( uint8_t bank ) {}
 uint8_t actuators_get_num( uint8_t bank ) { return 0; }
 
@@ -0,0 +1,151 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		comm_batch_udp.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Sends telemetry cycles of messages, 8 to 64 bytes each as wasp
+    messages are, to a UDP sink on loopback, once through
+    gtx_comm_batch.c with a flush per cycle and once with a send() per
+    message. The sink checks every message arrives intact and in order.
+    Reports syscalls and time per cycle for each:
+
+        make && ./comm_batch_udp [cycles] [msgs_per_cycle]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "gtx_comm_batch.h"
+
+#define MIN_MSG_LEN     8
+#define MAX_MSG_LEN     64
+
+static int sink;
+static long received, corrupt;
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+/* Message n is its length, its number, then a counting pattern */
+static int make_msg(unsigned long n, uint8_t *msg)
+{
+    int i, len = MIN_MSG_LEN + n * 7 % (MAX_MSG_LEN - MIN_MSG_LEN + 1);
+
+    msg[0] = len;
+    memcpy(msg + 1, &n, 4);
+    for (i = 5; i < len; i++)
+        msg[i] = n + i;
+    return len;
+}
+
+static void drain(unsigned long *expect)
+{
+    uint8_t got[MAX_MSG_LEN + 1], want[MAX_MSG_LEN];
+    int len;
+
+    while ((len = recv(sink, got, sizeof(got), MSG_DONTWAIT)) > 0)
+    {
+        if (len != make_msg(*expect, want) || memcmp(got, want, len))
+            corrupt++;
+        (*expect)++;
+        received++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long cycles = argc > 1 ? atol(argv[1]) : 10000;
+    int per_cycle = argc > 2 ? atoi(argv[2]) : 20;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int rcvbuf = 4 << 20, tx;
+    gtx_comm_batch_t b;
+    unsigned long n, expect;
+    long cycle, dropped = 0;
+    double t;
+
+    sink = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    setsockopt(sink, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    if (sink < 0 || bind(sink, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || getsockname(sink, (struct sockaddr *)&addr, &addr_len) < 0
+        || gtx_comm_batch_open(&b, "127.0.0.1", ntohs(addr.sin_port), 0) < 0)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    /* Batched, as gtx_comm.c drives it */
+    n = expect = 0;
+    t = now_us();
+    for (cycle = 0; cycle < cycles; cycle++)
+    {
+        int i, j;
+
+        for (i = 0; i < per_cycle; i++)
+        {
+            uint8_t msg[MAX_MSG_LEN];
+            int len = make_msg(n, msg);
+
+            if (gtx_comm_batch_free_space(&b) < len)
+                gtx_comm_batch_flush(&b);
+            if (gtx_comm_batch_free_space(&b) < len)
+            {
+                dropped++;
+                continue;
+            }
+            gtx_comm_batch_start(&b);
+            for (j = 0; j < len; j++)
+                gtx_comm_batch_put(&b, msg[j]);
+            if (gtx_comm_batch_end(&b) == 0)
+                n++;
+        }
+        gtx_comm_batch_flush(&b);
+        drain(&expect);
+    }
+    t = now_us() - t;
+    printf("batched:     %.2f syscalls/cycle, %.1f us/cycle, %lu sent, %ld received, %ld corrupt, %ld dropped\n",
+           (double)b.syscalls / cycles, t / cycles, b.msgs_sent, received, corrupt, dropped);
+
+    /* One send() per message */
+    tx = socket(AF_INET, SOCK_DGRAM, 0);
+    connect(tx, (struct sockaddr *)&addr, sizeof(addr));
+    received = corrupt = 0;
+    n = expect = 0;
+    t = now_us();
+    for (cycle = 0; cycle < cycles; cycle++)
+    {
+        int i;
+
+        for (i = 0; i < per_cycle; i++, n++)
+        {
+            uint8_t msg[MAX_MSG_LEN];
+            int len = make_msg(n, msg);
+
+            send(tx, msg, len, 0);
+        }
+        drain(&expect);
+    }
+    t = now_us() - t;
+    printf("per message: %.2f syscalls/cycle, %.1f us/cycle, %lu sent, %ld received, %ld corrupt\n",
+           (double)per_cycle, t / cycles, n, received, corrupt);
+
+    gtx_comm_batch_close(&b);
+    close(tx);
+    close(sink);
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		ppm_loopback.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Software model of /dev/rc_out looped back into /dev/rc. Frames of
+    random widths are encoded with src/ppm_enc.c, each edge is output
+    up to jitter_us late as the hrtimer might be, and the gaps between
+    falling edges are decoded with src/ppm.c using the standard timing
+    profile. The period is 22.5ms, or longer if the channels need it.
+    The frame is changed every few frames, mid-frame, to check
+    a frame is never sent half old and half new. Reports frames decoded
+    exactly and within the jitter, and the jitter statistics:
+
+        make && ./ppm_loopback [frames] [jitter_us] [channels] [seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ppm.h"
+#include "ppm_enc.h"
+
+#define FRAME_PERIOD_US     22500
+#define MARK_US             300
+#define SYNC_MIN_US         6500
+#define CHANNEL_MIN_US      1000
+#define CHANNEL_MAX_US      2000
+#define CHANGE_EVERY        3   /* Frames between changes */
+
+static const ppm_timing_t timing = { 6000, 15000, 500, 2500 };
+
+static void random_frame(unsigned int *value, unsigned int num_channels)
+{
+    unsigned int i;
+
+    for (i = 0; i < num_channels; i++)
+        value[i] = CHANNEL_MIN_US + rand() % (CHANNEL_MAX_US - CHANNEL_MIN_US + 1);
+}
+
+int main(int argc, char **argv)
+{
+    long frames = argc > 1 ? atol(argv[1]) : 100000;
+    unsigned int jitter_us = argc > 2 ? atoi(argv[2]) : 0;
+    unsigned int num_channels = argc > 3 ? atoi(argv[3]) : 8;
+    unsigned int seed = argc > 4 ? atoi(argv[4]) : 1;
+    unsigned int next[PPM_MAX_CHANNELS];
+    unsigned int history[CHANGE_EVERY + 2][PPM_MAX_CHANNELS];
+    ppm_enc_t enc;
+    ppm_enc_jitter_t jitter;
+    ppm_decoder_t dec;
+    unsigned int period_us;
+    long long due_us = 0, last_fall_us = 0;
+    long decoded = 0, exact = 0, close = 0, wrong = 0, segments = 0;
+    unsigned int i, started = 0;
+
+    if (num_channels == 0 || num_channels > PPM_MAX_CHANNELS)
+    {
+        fprintf(stderr, "channels must be 1 to %d\n", PPM_MAX_CHANNELS);
+        return 1;
+    }
+    srand(seed);
+    period_us = num_channels * CHANNEL_MAX_US + SYNC_MIN_US;
+    if (period_us < FRAME_PERIOD_US)
+        period_us = FRAME_PERIOD_US;
+
+    ppm_enc_init(&enc, MARK_US, SYNC_MIN_US);
+    ppm_enc_jitter_init(&jitter);
+    ppm_decoder_init(&dec);
+
+    random_frame(next, num_channels);
+    ppm_enc_set(&enc, num_channels, next, period_us);
+
+    while (decoded < frames && enc.frames < (unsigned int)frames * 2 + 10)
+    {
+        bool level, falling;
+        unsigned int segment_us = ppm_enc_next(&enc, &level, &falling);
+        long long late_us = jitter_us ? rand() % (jitter_us + 1) : 0;
+
+        /* The frame being sent, as ppm_enc_next() just picked it up */
+        if (enc.frames != started)
+        {
+            started = enc.frames;
+            for (i = 0; i < num_channels; i++)
+                history[started % (CHANGE_EVERY + 2)][i] = enc.value[i];
+        }
+
+        /* Change the frame part way through one, every few frames */
+        if (++segments % (2 * num_channels * CHANGE_EVERY + 3) == 0)
+        {
+            random_frame(next, num_channels);
+            ppm_enc_set(&enc, num_channels, next, period_us);
+        }
+
+        ppm_enc_jitter_record(&jitter, late_us * 1000);
+        if (falling)
+        {
+            long long t_us = due_us + late_us;
+
+            if (last_fall_us && ppm_decode(&dec, &timing, t_us - last_fall_us) == PPM_EVENT_FRAME)
+            {
+                /* The start pulse ending frame n arrives once frame n + 1
+                   has started */
+                unsigned int *truth = history[(started - 1) % (CHANGE_EVERY + 2)];
+                int err, max_err = 0;
+
+                for (i = 0; i < num_channels; i++)
+                {
+                    err = abs((int)dec.value[i] - (int)truth[i]);
+                    if (err > max_err)
+                        max_err = err;
+                }
+                decoded++;
+                if (max_err == 0)
+                    exact++;
+                else if (max_err <= (int)jitter_us)
+                    close++;
+                else
+                    wrong++;
+            }
+            last_fall_us = t_us;
+        }
+        due_us += segment_us;
+    }
+
+    printf("%ld frames decoded: %ld exact, %ld within %uus, %ld wrong\n",
+           decoded, exact, close, jitter_us, wrong);
+    printf("jitter: %u edges, mean %lld ns, max %u ns\n",
+           jitter.count, jitter.count ? jitter.sum_ns / jitter.count : 0, jitter.max_ns);
+
+    return wrong || decoded == 0 ? 1 : 0;
+}
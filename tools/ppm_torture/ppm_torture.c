@@ -0,0 +1,296 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		ppm_torture.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Feeds the PPM decoder from src/ppm.c with large numbers of
+    generated frames, corrupted in various ways, and reports for each
+    scenario:
+
+        false   frames reported by the decoder with wrong values, as a
+                fraction of all frames it reported
+        lost    clean frames the decoder did not report correctly
+        rejected frames the decoder counted as rejected and dropped
+        relock  time from the end of a run of corrupted frames until
+                the next correct frame, mean and worst case
+        stuck   whether the decoder never recovered from the last run
+                of corrupted frames
+
+    With "adaptive" the decoder learns its timing from the signal
+    rather than using the standard profile.
+
+        make && ./ppm_torture [frames per scenario] [seed] [adaptive]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "ppm.h"
+
+#define FRAME_PERIOD_US     22500
+#define CHANNEL_MIN_US      1000
+#define CHANNEL_MAX_US      2000
+#define DEFAULT_CHANNELS    8
+#define MAX_GAPS            (2 * PPM_MAX_CHANNELS + 2)
+
+typedef struct
+{
+    const char *name;
+    double glitch_rate;     /* Per gap: an extra edge splits the gap in two */
+    double drop_rate;       /* Per gap: a missing edge merges it with the next */
+    double truncate_rate;   /* Per frame: the frame ends early */
+    double change_rate;     /* Per frame: the number of channels changes,
+                               and the period by CHANNEL_MAX_US for each
+                               channel fewer than DEFAULT_CHANNELS, so the
+                               sync gap stays in the same range */
+    double drift;           /* Peak clock drift, as a fraction */
+    unsigned int period_us; /* Frame period, if not FRAME_PERIOD_US */
+    unsigned int sync_us;   /* Fixed start pulse, so the period varies
+                               with the channels, if not 0 */
+    double move_rate;       /* Per frame: the sticks move, if they are
+                               not to move every frame */
+} scenario_t;
+
+static const scenario_t scenarios[] =
+{
+    { "clean",          0,      0,      0,      0,      0 },
+    { "glitches",       0.001,  0,      0,      0,      0 },
+    { "missing edges",  0,      0.001,  0,      0,      0 },
+    { "truncated",      0,      0,      0.01,   0,      0 },
+    { "channel change", 0,      0,      0,      0.001,  0 },
+    { "drift 2%",       0,      0,      0,      0,      0.02 },
+    { "everything",     0.001,  0.001,  0.01,   0.001,  0.02 },
+    { "long frames",    0,      0,      0,      0,      0,      30000 },
+    { "variable period", 0,     0,      0,      0,      0,      0,      8000,   0.01 },
+    { "variable, all",  0.001,  0.001,  0.01,   0.001,  0.02,   0,      8000,   0.01 },
+};
+
+typedef struct
+{
+    unsigned int num_channels;
+    unsigned int value[PPM_MAX_CHANNELS];
+} truth_t;
+
+typedef struct
+{
+    unsigned long frames_sent;
+    unsigned long clean_sent;
+    unsigned long reported;
+    unsigned long correct;
+    unsigned long correct_clean;
+    unsigned long false_frames;
+    unsigned long disturbances;
+    unsigned long relocks;
+    unsigned long rejected;
+    int stuck;
+    double relock_total_us;
+    double relock_max_us;
+} result_t;
+
+static int adaptive;
+
+/* xorshift64, so runs are repeatable for a given seed */
+static unsigned long long rng_state;
+
+static double rng_uniform(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (rng_state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static unsigned int rng_range(unsigned int lo, unsigned int hi)
+{
+    return lo + (unsigned int)(rng_uniform() * (hi - lo + 1));
+}
+
+static int frame_matches(const ppm_decoder_t *dec, const truth_t *truth, unsigned int tolerance)
+{
+    unsigned int i;
+
+    if (dec->num_channels != truth->num_channels)
+        return 0;
+    for (i = 0; i < truth->num_channels; i++)
+    {
+        int err = (int)dec->value[i] - (int)truth->value[i];
+        if ((unsigned int)abs(err) > tolerance)
+            return 0;
+    }
+    return 1;
+}
+
+static void run(const scenario_t *sc, unsigned long num_frames, result_t *res)
+{
+    static const ppm_timing_t timing = { 6000, 15000, 500, 2500 };
+    ppm_decoder_t dec;
+    ppm_learner_t learn;
+    truth_t truth[2]; /* This frame and the one before */
+    unsigned int num_channels = DEFAULT_CHANNELS;
+    unsigned int tolerance = (unsigned int)ceil(sc->drift * CHANNEL_MAX_US) + 1;
+    unsigned int period_us = sc->period_us ? sc->period_us : FRAME_PERIOD_US;
+    unsigned int carry = 0; /* Gap merged into the next one by a missing edge */
+    double t_us = 0, disturbed_at = -1;
+    unsigned long k;
+
+    memset(res, 0, sizeof(*res));
+    ppm_decoder_init(&dec);
+    ppm_learner_init(&learn);
+    memset(truth, 0, sizeof(truth));
+
+    for (k = 0; k < num_frames; k++)
+    {
+        unsigned int gaps[MAX_GAPS], nominal[PPM_MAX_CHANNELS + 1];
+        unsigned int num_gaps = 0, sync_gap = 0, sent_channels, sum = 0, i;
+        double scale = 1 + sc->drift * sin(2 * M_PI * k / 5000.0);
+        int corrupted = 0;
+
+        if (rng_uniform() < sc->change_rate)
+        {
+            num_channels = rng_range(4, 8);
+            corrupted = 1;
+        }
+
+        truth[0] = truth[1];
+        truth[1].num_channels = num_channels;
+        for (i = 0; i < num_channels; i++)
+        {
+            if (sc->move_rate == 0 || rng_uniform() < sc->move_rate || truth[0].value[i] == 0)
+                truth[1].value[i] = rng_range(CHANNEL_MIN_US, CHANNEL_MAX_US);
+            sum += truth[1].value[i];
+        }
+
+        /* The frame as sent: channels, possibly cut short, then the start
+           pulse taking up the rest of the frame period, or of a fixed
+           length */
+        sent_channels = num_channels;
+        if (rng_uniform() < sc->truncate_rate)
+        {
+            sent_channels = rng_range(1, num_channels - 1);
+            corrupted = 1;
+        }
+        sum = 0;
+        for (i = 0; i < sent_channels; i++)
+        {
+            nominal[i] = truth[1].value[i];
+            sum += nominal[i];
+        }
+        if (sc->sync_us)
+            nominal[sent_channels] = sc->sync_us;
+        else
+            nominal[sent_channels] = period_us - (DEFAULT_CHANNELS - num_channels) * CHANNEL_MAX_US - sum;
+
+        /* Apply drift, glitches and missing edges */
+        for (i = 0; i <= sent_channels; i++)
+        {
+            unsigned int gap;
+
+            if (i == sent_channels)
+                sync_gap = num_gaps;
+            gap = (unsigned int)lround(nominal[i] * scale) + carry;
+            carry = 0;
+            if (rng_uniform() < sc->drop_rate)
+            {
+                carry = gap;
+                corrupted = 1;
+                continue;
+            }
+            if (rng_uniform() < sc->glitch_rate)
+            {
+                unsigned int split = rng_range(1, gap - 1);
+                gaps[num_gaps++] = split;
+                gap -= split;
+                corrupted = 1;
+            }
+            gaps[num_gaps++] = gap;
+        }
+
+        res->frames_sent++;
+        if (corrupted)
+            res->disturbances++;
+        else
+        {
+            res->clean_sent++;
+        }
+
+        for (i = 0; i < num_gaps; i++)
+        {
+            ppm_event_t event = adaptive
+                ? ppm_decode_adaptive(&dec, &learn, &timing, gaps[i])
+                : ppm_decode(&dec, &timing, gaps[i]);
+
+            t_us += gaps[i];
+            if (event == PPM_EVENT_FRAME)
+            {
+                /* Gaps from the start pulse at the end of this frame on end
+                   this frame. Any earlier gap ends the frame before. */
+                int ends_this = i >= sync_gap;
+                const truth_t *t = ends_this ? &truth[1] : &truth[0];
+
+                res->reported++;
+                if (frame_matches(&dec, t, tolerance))
+                {
+                    res->correct++;
+                    if (!corrupted && ends_this)
+                        res->correct_clean++;
+                    if (disturbed_at >= 0 && !corrupted && ends_this)
+                    {
+                        double relock = t_us - disturbed_at;
+                        res->relock_total_us += relock;
+                        if (relock > res->relock_max_us)
+                            res->relock_max_us = relock;
+                        res->relocks++;
+                        disturbed_at = -1;
+                    }
+                }
+                else
+                {
+                    res->false_frames++;
+                }
+            }
+        }
+
+        if (corrupted)
+            disturbed_at = t_us;
+    }
+
+    res->stuck = disturbed_at >= 0;
+    res->rejected = dec.rejects.bounds + dec.rejects.count + dec.rejects.length;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long num_frames = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    unsigned int i;
+
+    rng_state = argc > 2 ? strtoull(argv[2], NULL, 0) : 0x2545F4914F6CDD1DULL;
+    if (rng_state == 0)
+        rng_state = 1;
+    adaptive = argc > 3 && strcmp(argv[3], "adaptive") == 0;
+
+    printf("%lu frames per scenario, %d channels, %d us frames, %s timing\n\n", num_frames, DEFAULT_CHANNELS, FRAME_PERIOD_US, adaptive ? "adaptive" : "standard");
+    printf("%-16s %10s %10s %10s %10s %10s %12s %12s %8s\n", "scenario", "disturbed", "false", "false %", "lost", "rejected", "relock mean", "relock max", "stuck");
+
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++)
+    {
+        result_t res;
+
+        run(&scenarios[i], num_frames, &res);
+
+        printf("%-16s %10lu %10lu %9.4f%% %10lu %10lu %10.1fms %10.1fms %8s\n",
+               scenarios[i].name,
+               res.disturbances,
+               res.false_frames,
+               res.reported ? 100.0 * res.false_frames / res.reported : 0.0,
+               res.clean_sent - res.correct_clean,
+               res.rejected,
+               res.relocks ? res.relock_total_us / res.relocks / 1000 : 0.0,
+               res.relock_max_us / 1000,
+               res.stuck ? "yes" : "no");
+    }
+
+    return 0;
+}
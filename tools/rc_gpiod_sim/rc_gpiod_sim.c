@@ -0,0 +1,185 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		rc_gpiod_sim.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    End to end test of the userspace decoder (gtx_rc_gpiod.c) on a host.
+    A thread generates a PPM signal on a gpio-sim line by toggling its
+    pull, while the main loop polls the decoder at 200Hz like the
+    control loop would, checks every channel against what was sent and
+    reports the CPU cost per edge.
+
+    Set up a gpio-sim chip first (as root):
+
+        modprobe gpio-sim
+        mkdir -p /sys/kernel/config/gpio-sim/rc/bank0
+        echo 1 > /sys/kernel/config/gpio-sim/rc/bank0/num_lines
+        echo 1 > /sys/kernel/config/gpio-sim/rc/live
+        cat /sys/kernel/config/gpio-sim/rc/dev_name         # e.g. gpio-sim.0
+        cat /sys/kernel/config/gpio-sim/rc/bank0/chip_name  # e.g. gpiochip1
+
+    then
+
+        make && ./rc_gpiod_sim /dev/gpiochip1 \
+            /sys/devices/platform/gpio-sim.0/gpiochip1/sim_gpio0/pull [seconds]
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gtx_rc_gpiod.h"
+
+#define FRAME_PERIOD_US     22500
+#define MARK_US             300  /* Low time at the start of each gap */
+#define NUM_CHANNELS        8
+#define POLL_US             5000 /* i.e. a 200Hz control loop */
+#define TOLERANCE_US        50   /* Allowed for sysfs write latency */
+
+static int pull_fd;
+static volatile int running = 1;
+static volatile uint16_t sent[NUM_CHANNELS];      /* Frame being sent */
+static volatile uint16_t prev_sent[NUM_CHANNELS]; /* Frame before it */
+
+static void sleep_until(struct timespec *t, long us)
+{
+    t->tv_nsec += us * 1000;
+    while (t->tv_nsec >= 1000000000L)
+    {
+        t->tv_nsec -= 1000000000L;
+        t->tv_sec++;
+    }
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, t, NULL);
+}
+
+static void set_line(int high)
+{
+    const char *pull = high ? "pull-up" : "pull-down";
+
+    if (pwrite(pull_fd, pull, strlen(pull), 0) < 0)
+        perror("pull");
+}
+
+/* Slowly sweeps every channel, each at its own rate */
+static void *generate(void *arg)
+{
+    struct timespec t;
+    unsigned int frame = 0;
+    int channel;
+
+    (void)arg;
+    set_line(1);
+    clock_gettime(CLOCK_MONOTONIC, &t);
+
+    while (running)
+    {
+        long used = 0;
+
+        for (channel = 0; channel < NUM_CHANNELS; channel++)
+        {
+            prev_sent[channel] = sent[channel];
+            sent[channel] = 1000 + ((frame * (channel + 1) * 7) % 1000);
+        }
+
+        for (channel = 0; channel <= NUM_CHANNELS; channel++)
+        {
+            long gap = channel < NUM_CHANNELS ? sent[channel] : FRAME_PERIOD_US - used;
+
+            /* The falling edge ends the previous gap */
+            set_line(0);
+            sleep_until(&t, MARK_US);
+            set_line(1);
+            sleep_until(&t, gap - MARK_US);
+            used += gap;
+        }
+        frame++;
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    gtx_rc_gpiod_stats_t stats;
+    gtx_rc_parse_status_t status;
+    uint16_t pulses[NUM_CHANNELS];
+    unsigned long polls = 0, ok = 0, checked = 0, wrong = 0;
+    pthread_t thread;
+    struct timespec t;
+    int seconds, i;
+
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s gpiochip sim_gpio_pull_path [seconds]\n", argv[0]);
+        return 1;
+    }
+    seconds = argc > 3 ? atoi(argv[3]) : 10;
+
+    pull_fd = open(argv[2], O_WRONLY);
+    if (pull_fd < 0)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+    if (gtx_rc_gpiod_open(argv[1], 0) < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    pthread_create(&thread, NULL, generate, NULL);
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    for (i = 0; i < seconds * (1000000 / POLL_US); i++)
+    {
+        int num_channels, channel, bad = 0;
+
+        sleep_until(&t, POLL_US);
+        num_channels = gtx_rc_gpiod_poll(&status, pulses, NUM_CHANNELS);
+        polls++;
+        if (num_channels < 0)
+        {
+            fprintf(stderr, "poll failed\n");
+            break;
+        }
+        if (status != GTX_RC_PARSE_OK)
+            continue;
+        ok++;
+
+        /* The frame decoded may be one behind the one being sent, so
+           only count it as wrong if it matches neither */
+        if (num_channels != NUM_CHANNELS)
+        {
+            wrong++;
+            continue;
+        }
+        for (channel = 0; channel < NUM_CHANNELS; channel++)
+        {
+            int diff = abs((int)pulses[channel] - sent[channel]);
+            int prev_diff = abs((int)pulses[channel] - prev_sent[channel]);
+            if (diff > TOLERANCE_US && prev_diff > TOLERANCE_US)
+                bad = 1;
+        }
+        checked++;
+        wrong += bad;
+    }
+
+    running = 0;
+    pthread_join(thread, NULL);
+    gtx_rc_gpiod_get_stats(&stats);
+    gtx_rc_gpiod_close();
+
+    printf("polls %lu, status OK %lu, frames checked %lu, wrong %lu\n", polls, ok, checked, wrong);
+    printf("edges %llu in %llu reads (%.1f per syscall)\n",
+           (unsigned long long)stats.edges, (unsigned long long)stats.batches,
+           stats.batches ? (double)stats.edges / stats.batches : 0.0);
+    printf("cpu %.0f ns per edge\n", stats.edges ? (double)stats.cpu_ns / stats.edges : 0.0);
+
+    return wrong != 0;
+}
@@ -0,0 +1,87 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		rc_latency_bench.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Runs the gtx_latency.c stand-in RC source through a loop shaped like
+    the onboard one, without the rest of wasp: read the frame, normalize
+    it, command the actuators, sleep until the next tick. Shows what the
+    loop rate alone costs in latency before building the autopilot with
+    GTX_LATENCY_BENCH:
+
+        make && ./rc_latency_bench [loop_hz] [seconds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "gtx_latency.h"
+
+#define MAX_CHANNELS    20
+
+static volatile int sink;
+
+/* A copy of ThisNormalizePpm() in gtx_rc.c, which cannot be linked
+   without the rest of wasp */
+#define MIN_PULSE_LIMIT    500
+#define MAX_PULSE_LIMIT    2500
+#define NEUTRAL_PULSE      1500
+static int normalize(int val)
+{
+    int ret = val - NEUTRAL_PULSE;
+    if (ret > 0)
+        ret = ret * 9600 / MAX_PULSE_LIMIT;
+    else
+        ret = ret * 9600 / MIN_PULSE_LIMIT;
+    return ret;
+}
+
+int main(int argc, char **argv)
+{
+    int loop_hz = argc > 1 ? atoi(argv[1]) : 60;
+    int seconds = argc > 2 ? atoi(argv[2]) : 120;
+    uint16_t pulses[MAX_CHANNELS];
+    struct timespec next;
+    long period_ns, ticks, tick;
+
+    if (loop_hz <= 0 || seconds <= 0)
+    {
+        fprintf(stderr, "usage: %s [loop_hz] [seconds]\n", argv[0]);
+        return 1;
+    }
+    period_ns = 1000000000L / loop_hz;
+    ticks = (long)loop_hz * seconds;
+
+    gtx_latency_init();
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    for (tick = 0; tick < ticks; tick++)
+    {
+        gtx_rc_parse_status_t status;
+        int channel, num_channels;
+
+        num_channels = gtx_latency_source_read(&status, pulses, MAX_CHANNELS);
+        if (num_channels > 0)
+        {
+            for (channel = 0; channel < num_channels; channel++)
+                sink = normalize(pulses[channel]);
+            gtx_latency_stamp(GTX_LATENCY_NORMALIZED);
+            gtx_latency_stamp(GTX_LATENCY_ACTUATOR);
+        }
+
+        next.tv_nsec += period_ns;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_nsec -= 1000000000L;
+            next.tv_sec++;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+    }
+
+    /* The frames since the last full report */
+    gtx_latency_report();
+
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		rc_logger.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Records every RC frame for post-flight analysis. /dev/rc is switched
+    to binary reads (RC_IOC_SET_FORMAT), so each read() returns every
+    frame since the last one as fixed size struct rc_frame_record, and
+    the records are copied straight into a preallocated, memory mapped
+    log segment. No formatting, stdio or write() per frame.
+
+    Segments are dir/rc-NNNNNN.log, each a header followed by records.
+    The header holds the count and the times of the first and last
+    record, and is kept up to date, so a segment cut short by a power
+    failure is still readable up to about its last flush. A full segment is
+    closed and its times appended to dir/index, one line per segment:
+
+        NNNNNN first_ns last_ns records
+
+    and only the newest max_segments are kept. A restart carries on
+    from the segment after the newest in dir, and counts the earlier
+    runs' segments towards max_segments. Dirty pages are handed
+    to the kernel with msync(MS_ASYNC) every flush_ms, so nothing waits
+    for the flash.
+
+    The decoder never waits for a reader, and the logger runs at a low
+    priority (nice 10) so it never competes with the control loop. If it
+    falls more than a ring behind, frames are lost rather than delayed,
+    and show as gaps in seq.
+
+        rc_logger [-D device] [-d dir] [-s segment_kb] [-n max_segments] [-f flush_ms]
+        rc_logger -p segment      print a segment as text, one line per
+                                  frame: time_ns,seq,source,age_us,values...
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "rc_ioctl.h"
+
+#define LOG_MAGIC           "RCLOG1"
+#define READ_RECORDS        64
+#define PATH_WIDTH          256
+
+/* The same size as a record, so records stay aligned */
+typedef struct
+{
+    char magic[8];
+    uint32_t record_size;
+    uint32_t count;
+    uint64_t first_ns;
+    uint64_t last_ns;
+    uint32_t segment;
+    uint32_t reserved[7];
+} log_header_t;
+
+typedef struct
+{
+    const char *dir;
+    size_t segment_size;
+    unsigned int max_segments;
+    unsigned int flush_ms;
+
+    int fd;
+    uint8_t *map;
+    log_header_t *header;
+    struct rc_frame_record *records;
+    uint32_t capacity;
+    uint32_t segment;
+    uint32_t flushed;       /* Records handed to the kernel by msync() */
+} log_t;
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig)
+{
+    stop = 1;
+}
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000ULL + ts.tv_nsec / 1000000;
+}
+
+static void segment_path(const log_t *log, uint32_t segment, char *path)
+{
+    snprintf(path, PATH_WIDTH, "%s/rc-%06u.log", log->dir, segment);
+}
+
+/* Hands the records written since the last flush to the kernel */
+static void log_flush(log_t *log)
+{
+    long page = sysconf(_SC_PAGESIZE);
+    size_t from, to;
+
+    if (log->map == NULL || log->header->count == log->flushed)
+        return;
+
+    from = sizeof(log_header_t) + (size_t)log->flushed * sizeof(struct rc_frame_record);
+    to = sizeof(log_header_t) + (size_t)log->header->count * sizeof(struct rc_frame_record);
+    from &= ~(page - 1);
+
+    /* MS_ASYNC only schedules the write-back, in no particular order, so
+       after a power failure the count on disk may be ahead of or behind
+       the records that made it. The file is preallocated, so any missing
+       ones read back as zeros. */
+    msync(log->map + from, to - from, MS_ASYNC);
+    msync(log->map, page, MS_ASYNC);
+    log->flushed = log->header->count;
+}
+
+static int log_open_segment(log_t *log)
+{
+    char path[PATH_WIDTH];
+
+    segment_path(log, log->segment, path);
+    log->fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (log->fd < 0)
+    {
+        perror(path);
+        return -1;
+    }
+
+    /* Allocate every block now, so filling the map never faults into
+       the filesystem's allocator or finds the disk full */
+    errno = posix_fallocate(log->fd, 0, log->segment_size);
+    if (errno)
+    {
+        perror("posix_fallocate");
+        close(log->fd);
+        return -1;
+    }
+
+    log->map = mmap(NULL, log->segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, log->fd, 0);
+    if (log->map == MAP_FAILED)
+    {
+        perror("mmap");
+        log->map = NULL;
+        close(log->fd);
+        return -1;
+    }
+
+    log->header = (log_header_t *)log->map;
+    log->records = (struct rc_frame_record *)(log->map + sizeof(log_header_t));
+    log->capacity = (log->segment_size - sizeof(log_header_t)) / sizeof(struct rc_frame_record);
+    log->flushed = 0;
+
+    memset(log->header, 0, sizeof(*log->header));
+    memcpy(log->header->magic, LOG_MAGIC, sizeof(LOG_MAGIC));
+    log->header->record_size = sizeof(struct rc_frame_record);
+    log->header->segment = log->segment;
+
+    return 0;
+}
+
+static void log_close_segment(log_t *log)
+{
+    char path[PATH_WIDTH];
+    FILE *index;
+
+    if (log->map == NULL)
+        return;
+
+    log_flush(log);
+    snprintf(path, sizeof(path), "%s/index", log->dir);
+    index = fopen(path, "a");
+    if (index != NULL)
+    {
+        fprintf(index, "%06u %llu %llu %u\n", log->segment,
+                (unsigned long long)log->header->first_ns,
+                (unsigned long long)log->header->last_ns, log->header->count);
+        fclose(index);
+    }
+
+    munmap(log->map, log->segment_size);
+    log->map = NULL;
+    close(log->fd);
+
+    /* Drop the oldest segment beyond max_segments */
+    if (log->segment >= log->max_segments)
+    {
+        segment_path(log, log->segment - log->max_segments, path);
+        unlink(path);
+    }
+    log->segment++;
+}
+
+static int log_append(log_t *log, const struct rc_frame_record *record, int n)
+{
+    while (n > 0)
+    {
+        uint32_t room, count;
+
+        if (log->map == NULL && log_open_segment(log) < 0)
+            return -1;
+
+        count = log->header->count;
+        room = log->capacity - count;
+        if (room > (uint32_t)n)
+            room = n;
+
+        memcpy(&log->records[count], record, room * sizeof(*record));
+        if (count == 0)
+            log->header->first_ns = record[0].time_ns;
+        log->header->last_ns = record[room - 1].time_ns;
+        log->header->count = count + room;
+
+        record += room;
+        n -= room;
+        if (log->header->count == log->capacity)
+            log_close_segment(log);
+    }
+    return 0;
+}
+
+/* The number of a segment file name, or -1 if name is not one */
+static long segment_number(const char *name)
+{
+    unsigned int segment;
+    int len = 0;
+
+    if (sscanf(name, "rc-%6u.log%n", &segment, &len) != 1 || len != 13 || name[len] != '\0')
+        return -1;
+    return segment;
+}
+
+/* The segment after the newest already in dir, so a restart never
+   overwrites one. The older ones are then dropped down to max_segments,
+   as if this run had written them. */
+static uint32_t first_free_segment(const log_t *log)
+{
+    char path[PATH_WIDTH];
+    struct dirent *entry;
+    uint32_t segment = 0;
+    long n;
+    DIR *dir;
+
+    dir = opendir(log->dir);
+    if (dir == NULL)
+        return 0;
+    while ((entry = readdir(dir)) != NULL)
+    {
+        n = segment_number(entry->d_name);
+        if (n >= 0 && (uint32_t)n >= segment)
+            segment = n + 1;
+    }
+
+    rewinddir(dir);
+    while ((entry = readdir(dir)) != NULL)
+    {
+        n = segment_number(entry->d_name);
+        if (n >= 0 && (uint32_t)n + log->max_segments < segment)
+        {
+            segment_path(log, n, path);
+            unlink(path);
+        }
+    }
+    closedir(dir);
+
+    return segment;
+}
+
+static int print_segment(const char *path)
+{
+    const struct rc_frame_record *records;
+    const log_header_t *header;
+    struct stat st;
+    uint32_t i, j, count;
+    uint8_t *map;
+    int fd;
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0 || fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(log_header_t))
+    {
+        perror(path);
+        return 1;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+
+    header = (const log_header_t *)map;
+    records = (const struct rc_frame_record *)(map + sizeof(log_header_t));
+    if (memcmp(header->magic, LOG_MAGIC, sizeof(LOG_MAGIC)) || header->record_size != sizeof(*records))
+    {
+        fprintf(stderr, "%s: not a log segment\n", path);
+        return 1;
+    }
+    count = header->count;
+    if (count > (st.st_size - sizeof(log_header_t)) / sizeof(*records))
+        count = (st.st_size - sizeof(log_header_t)) / sizeof(*records);
+
+    for (i = 0; i < count; i++)
+    {
+        printf("%llu,%u,%u,%u", (unsigned long long)records[i].time_ns, records[i].seq,
+               records[i].source, records[i].age_us);
+        for (j = 0; j < records[i].num_channels && j < RC_RECORD_MAX_CHANNELS; j++)
+            printf(",%u", records[i].value_us[j]);
+        printf("\n");
+    }
+
+    munmap(map, st.st_size);
+    close(fd);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    struct rc_frame_record records[READ_RECORDS];
+    const char *device = "/dev/rc";
+    uint32_t format = RC_FORMAT_BINARY;
+    struct sigaction action;
+    uint64_t last_flush;
+    log_t log;
+    int opt, fd;
+
+    memset(&log, 0, sizeof(log));
+    log.dir = ".";
+    log.segment_size = 4096 * 1024;
+    log.max_segments = 64;
+    log.flush_ms = 1000;
+
+    while ((opt = getopt(argc, argv, "D:d:s:n:f:p:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'D': device = optarg; break;
+            case 'd': log.dir = optarg; break;
+            case 's': log.segment_size = atol(optarg) * 1024; break;
+            case 'n': log.max_segments = atoi(optarg); break;
+            case 'f': log.flush_ms = atoi(optarg); break;
+            case 'p': return print_segment(optarg);
+            default:
+                fprintf(stderr, "usage: %s [-D device] [-d dir] [-s segment_kb] [-n max_segments] [-f flush_ms]\n"
+                                "       %s -p segment\n", argv[0], argv[0]);
+                return 1;
+        }
+    }
+    if (log.segment_size < sizeof(log_header_t) + sizeof(struct rc_frame_record) || log.max_segments == 0)
+    {
+        fprintf(stderr, "segment or max_segments too small\n");
+        return 1;
+    }
+
+    fd = open(device, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        perror(device);
+        return 1;
+    }
+    /* A file or pipe of records can be replayed through the logger */
+    if (ioctl(fd, RC_IOC_SET_FORMAT, &format) < 0 && errno != ENOTTY)
+    {
+        perror("RC_IOC_SET_FORMAT");
+        return 1;
+    }
+
+    setpriority(PRIO_PROCESS, 0, 10);
+    /* No SA_RESTART, so a signal breaks the read() it arrives in */
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    log.segment = first_free_segment(&log);
+    log.map = NULL;
+    last_flush = now_ms();
+
+    while (!stop)
+    {
+        ssize_t len = read(fd, records, sizeof(records));
+
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("read");
+            break;
+        }
+        if (len == 0)
+            break;
+        if (log_append(&log, records, len / sizeof(records[0])) < 0)
+            break;
+
+        if (now_ms() - last_flush >= log.flush_ms)
+        {
+            log_flush(&log);
+            last_flush = now_ms();
+        }
+    }
+
+    log_close_segment(&log);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,111 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		rc_parse_bench.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Compares the cost of parsing /dev/rc text lines with
+    gtx_rc_parse_line() against the original strtok/atoi/strcmp code
+    from gtx_rc.c. Run on the host or on the Overo:
+
+        make && ./rc_parse_bench [lines] [channels]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "gtx_rc_parse.h"
+
+#define LINE_WIDTH      128
+#define MAX_CHANNELS    20
+#define NUM_DISTINCT    1024 /* Distinct lines, so the branch predictor can not learn them */
+
+static volatile int sink;
+
+/* The original parser from gtx_rc.c, status check included */
+static int legacy_parse_line(char *line, uint16_t *pulses)
+{
+    int channel = 0, status;
+    char *token;
+
+    token = strtok (line, ",");
+    if (strcmp (token, "RC_OK"))
+        status = 0;
+    else if (strcmp (token, "RC_LOST"))
+        status = 1;
+    else
+        status = 2;
+
+    while ((token = strtok (NULL, ",")) != NULL)
+    {
+        pulses[channel] = atoi(token);
+        channel++;
+    }
+    return channel + status;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char **argv)
+{
+    static char lines[NUM_DISTINCT][LINE_WIDTH];
+    static int lens[NUM_DISTINCT];
+    static const char *statuses[] = { "RC_OK", "RC_LOST", "RC_REALLY_LOST" };
+    char scratch[LINE_WIDTH];
+    uint16_t pulses[MAX_CHANNELS];
+    gtx_rc_parse_status_t status;
+    long num_lines = argc > 1 ? atol(argv[1]) : 10000000;
+    int num_channels = argc > 2 ? atoi(argv[2]) : 8;
+    double start, legacy_ns, parse_ns;
+    long i;
+    int j;
+
+    if (num_channels < 1 || num_channels > MAX_CHANNELS)
+    {
+        fprintf(stderr, "channels must be 1 to %d\n", MAX_CHANNELS);
+        return 1;
+    }
+
+    /* Mostly RC_OK lines, as when flying */
+    srand(1);
+    for (i = 0; i < NUM_DISTINCT; i++)
+    {
+        int pos = sprintf(lines[i], "%s", statuses[(i % 16) == 0 ? 1 + (i / 16) % 2 : 0]);
+        for (j = 0; j < num_channels; j++)
+            pos += sprintf(lines[i] + pos, ",%d", 1000 + rand() % 1001);
+        pos += sprintf(lines[i] + pos, "\n");
+        lens[i] = pos;
+    }
+
+    start = now_ns();
+    for (i = 0; i < num_lines; i++)
+    {
+        /* strtok modifies the line, so it has to work on a copy, just
+           as it worked on the buffer it had read into */
+        memcpy(scratch, lines[i % NUM_DISTINCT], lens[i % NUM_DISTINCT] + 1);
+        sink = legacy_parse_line(scratch, pulses);
+    }
+    legacy_ns = (now_ns() - start) / num_lines;
+
+    start = now_ns();
+    for (i = 0; i < num_lines; i++)
+    {
+        memcpy(scratch, lines[i % NUM_DISTINCT], lens[i % NUM_DISTINCT] + 1);
+        sink = gtx_rc_parse_line(scratch, lens[i % NUM_DISTINCT], &status, pulses, MAX_CHANNELS) + status;
+    }
+    parse_ns = (now_ns() - start) / num_lines;
+
+    printf("%ld lines of %d channels\n", num_lines, num_channels);
+    printf("strtok/atoi/strcmp: %6.1f ns/line %5.1f ns/channel\n", legacy_ns, legacy_ns / num_channels);
+    printf("gtx_rc_parse_line:  %6.1f ns/line %5.1f ns/channel (%.1fx)\n", parse_ns, parse_ns / num_channels, legacy_ns / parse_ns);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+/*
+    ENEL675 - Advanced Embedded Systems
+    File: 		rc_telemetry_udp.c
+    Author: 	        agent
+    Date:  		19 October 2026
+
+    Sends synthetic RC frames through gtx_rc_telemetry.c over loopback
+    UDP, one datagram per frame, and checks every packet the receiver
+    accepts against what was sent. Four sticks move with a little pulse
+    jitter and four switches sit still. The stream is sent once without
+    loss, once with every loss_every'th packet dropped before sending,
+    and once with outages of 200 to 600 packets, long enough for the
+    sticks to walk and the sequence number to wrap. Every packet but
+    those whose keyframe was lost must decode, so a lost delta costs only
+    its own frame, and none may decode wrongly. Reports the bytes per
+    frame against the /dev/rc text line and a keyframe-only stream:
+
+        make && ./rc_telemetry_udp [frames] [loss_every]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "gtx_rc_telemetry.h"
+
+#define NUM_CHANNELS    8
+#define NUM_STICKS      4
+#define TEXT_WIDTH      160
+#define OUTAGE_GAP      2000 /* Mean packets between outages */
+#define OUTAGE_MIN      200
+#define OUTAGE_MAX      600
+
+static void make_frame(long frame, uint16_t *pulses)
+{
+    int channel;
+
+    for (channel = 0; channel < NUM_STICKS; channel++)
+        pulses[channel] = 1500 + 400 * sin(frame * 0.01 * (channel + 1)) + (rand() % 3 - 1);
+    for (; channel < NUM_CHANNELS; channel++)
+        pulses[channel] = channel & 1 ? 1100 : 1900;
+}
+
+typedef struct
+{
+    long sent, received, rejected, mismatched;
+    long orphaned;      /* Deltas sent after their keyframe was dropped */
+    long unexpected;    /* Rejected although their keyframe arrived */
+    long outages;
+    long packet_bytes, text_bytes;
+} result_t;
+
+/* Returns 0 if every packet was checked, -1 on a socket error */
+static int run(int tx, int rx, const struct sockaddr_in *addr, long frames, long loss_every,
+               int outages, result_t *res)
+{
+    gtx_rc_telemetry_t enc, dec;
+    int key_lost = 0;
+    long frame, outage_start = -1, outage_end = -1;
+
+    memset(res, 0, sizeof(*res));
+    gtx_rc_telemetry_init(&enc);
+    gtx_rc_telemetry_init(&dec);
+    srand(1);
+
+    for (frame = 0; frame < frames; frame++)
+    {
+        uint16_t pulses[NUM_CHANNELS], decoded[GTX_RC_TELEMETRY_MAX_CHANNELS];
+        uint8_t buf[GTX_RC_TELEMETRY_MAX_LEN];
+        char text[TEXT_WIDTH];
+        gtx_rc_parse_status_t status;
+        int channel, len, num_channels, pos, keyframe;
+
+        make_frame(frame, pulses);
+        pos = snprintf(text, sizeof(text), "RC_OK");
+        for (channel = 0; channel < NUM_CHANNELS; channel++)
+            pos += snprintf(text + pos, sizeof(text) - pos, ",%u", pulses[channel]);
+        res->text_bytes += pos + 1;
+
+        len = gtx_rc_telemetry_encode(&enc, GTX_RC_PARSE_OK, pulses, NUM_CHANNELS, buf);
+        res->packet_bytes += len;
+        keyframe = buf[2] & 0x80;
+        if (outages && frame >= outage_end)
+        {
+            outage_start = frame + 1 + rand() % (2 * OUTAGE_GAP);
+            outage_end = outage_start + OUTAGE_MIN + rand() % (OUTAGE_MAX - OUTAGE_MIN + 1);
+            res->outages++;
+        }
+        if ((loss_every && frame % loss_every == loss_every - 1)
+            || (outages && frame >= outage_start))
+        {
+            if (keyframe)
+                key_lost = 1;
+            continue;
+        }
+        if (keyframe)
+            key_lost = 0;
+        else if (key_lost)
+            res->orphaned++;
+        if (sendto(tx, buf, len, 0, (const struct sockaddr *)addr, sizeof(*addr)) != len)
+        {
+            perror("sendto");
+            return -1;
+        }
+        res->sent++;
+
+        len = recv(rx, buf, sizeof(buf), 0);
+        if (len < 0)
+        {
+            perror("recv");
+            return -1;
+        }
+        num_channels = gtx_rc_telemetry_decode(&dec, buf, len, &status, decoded);
+        if (num_channels < 0)
+        {
+            res->rejected++;
+            if (!key_lost)
+                res->unexpected++;
+            continue;
+        }
+        res->received++;
+        if (num_channels != NUM_CHANNELS || status != GTX_RC_PARSE_OK
+            || memcmp(decoded, pulses, sizeof(pulses)))
+            res->mismatched++;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long frames = argc > 1 ? atol(argv[1]) : 100000;
+    long loss_every = argc > 2 ? atol(argv[2]) : 7;
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    result_t res;
+    double packed = 0, text = 0;
+    int tx, rx, pass, failed = 0;
+
+    tx = socket(AF_INET, SOCK_DGRAM, 0);
+    rx = socket(AF_INET, SOCK_DGRAM, 0);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (tx < 0 || rx < 0 || bind(rx, (struct sockaddr *)&addr, sizeof(addr)) < 0
+        || getsockname(rx, (struct sockaddr *)&addr, &addr_len) < 0)
+    {
+        perror("socket");
+        return 1;
+    }
+
+    for (pass = 0; pass < 3; pass++)
+    {
+        long loss = pass == 1 ? loss_every : 0;
+        int ok;
+
+        if (pass == 1 && loss_every <= 0)
+            continue;
+        if (run(tx, rx, &addr, frames, loss, pass == 2, &res))
+            return 1;
+        if (pass == 0)
+        {
+            packed = (double)res.packet_bytes / frames;
+            text = (double)res.text_bytes / frames;
+        }
+
+        /* Only deltas whose keyframe was lost may be rejected, and an
+           older keyframe with the same values is as good as theirs */
+        ok = res.mismatched == 0 && res.unexpected == 0;
+        failed |= !ok;
+        if (pass == 2)
+            printf("%ld outages: ", res.outages);
+        else if (loss)
+            printf("loss 1 in %ld: ", loss);
+        else
+            printf("no loss:   ");
+        printf("%ld frames, %ld sent, %ld decoded, %ld rejected (%ld with their keyframe lost), %ld mismatched: %s\n",
+               frames, res.sent, res.received, res.rejected, res.orphaned, res.mismatched, ok ? "OK" : "FAIL");
+    }
+    printf("bytes per frame: %.2f packed, %d keyframe only, %.2f text line\n",
+           packed, 3 + (NUM_CHANNELS * GTX_RC_TELEMETRY_PULSE_BITS + 7) / 8 + 2, text);
+
+    close(tx);
+    close(rx);
+    return failed;
+}